@@ -0,0 +1,61 @@
+/**
+ * @file
+ * @author  Chrisitan Urich <christian.urich@gmail.com>
+ * @version 1.0
+ * @section LICENSE
+ *
+ * This file is part of DynaMind
+ *
+ * Copyright (C) 2012  Christian Urich
+
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef INITDATA_H
+#define INITDATA_H
+
+#include "dmcompilersettings.h"
+#include "dmmodule.h"
+#include "dm.h"
+
+using namespace DM;
+
+/** @ingroup TestModules
+ * @brief Declares its data in every init call, even if nothing changed
+ *
+ * Data Set:
+ * - Inport:
+ *      - Read
+ *          - Inlets|NODE: A, B, filtered by x > 0
+ *      - Add
+ *          - Inlets|NODE: C
+ *
+ */
+class DM_HELPER_DLL_EXPORT InitData : public  Module {
+
+    DM_DECLARE_NODE( InitData )
+
+public:
+    InitData();
+
+    /** @brief declares the data again */
+    void init();
+
+    /** @brief Does nothing */
+    void run();
+};
+
+#endif // INITDATA_H
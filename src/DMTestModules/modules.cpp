@@ -30,6 +30,7 @@
 #include "inout2.h"
 #include "dynamicinout.h"
 #include "grouptest.h"
+#include "initdata.h"
 #include "createnodes.h"
 #include "createallcomponents.h"
 #include "reallocator.h"
@@ -50,6 +51,7 @@ extern "C" void DM_HELPER_DLL_EXPORT  registerModules(ModuleRegistry *registry)
     registry->addNodeFactory(new NodeFactory<Reallocator>());
     registry->addNodeFactory(new NodeFactory<CheckAllComponenets>());
     registry->addNodeFactory(new NodeFactory<SuccessorCheck>());
+    registry->addNodeFactory(new NodeFactory<InitData>());
 
 }
 
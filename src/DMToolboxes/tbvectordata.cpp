@@ -31,6 +31,7 @@
 #include "tbvectordata.h"
 #include "dm.h"
 #include <dmrasterdata.h>
+#include <dmdataviewer.h>
 #include <dmstdutilities.h>
 
 #include <QtGlobal>
@@ -38,7 +39,7 @@
 
 DM::Edge * TBVectorData::getEdge(DM::System * sys, DM::View & view, DM::Node * n1, DM::Node * n2, bool OrientationMatters) {
 
-    DM::Edge * e1 = sys->getEdge(n1->getUUID(), n2->getUUID());
+    DM::Edge * e1 = sys->getEdge(n1, n2);
 
     if (e1!=0) {
         if (view.getName().empty()) {
@@ -52,7 +53,7 @@ DM::Edge * TBVectorData::getEdge(DM::System * sys, DM::View & view, DM::Node * n
 
     }
     if (!OrientationMatters) {
-        e1 = sys->getEdge(n2->getUUID(), n1->getUUID());
+        e1 = sys->getEdge(n2, n1);
         if (e1!=0) {
             if (view.getName().empty()) {
                 return e1;
@@ -74,8 +75,8 @@ DM::Edge * TBVectorData::getEdge(DM::System * sys, DM::View & view, DM::Edge * e
 
     return TBVectorData::getEdge(sys,
                                  view,
-                                 (DM::Node *) sys->getNode(e->getStartpointName()),
-                                 (DM::Node *) sys->getNode(e->getEndpointName()),
+                                 e->getStartNode(),
+                                 e->getEndNode(),
                                  OrientationMatters);
 }
 
@@ -639,9 +640,24 @@ bool TBVectorData::GetViewExtend(DM::System * sys, DM::View & view, double & x_m
     }
 
     std::vector<DM::Node * > nodes;
-    if (view.getType() == DM::NODE) TBVectorData::GetNodesFromNodes(sys, view, nodes);
-    if (view.getType() == DM::EDGE) TBVectorData::GetNodesFromEdges(sys, view, nodes);
-    if (view.getType() == DM::FACE) TBVectorData::GetNodesFromFaces(sys, view, nodes);
+    // only coordinates are read, the data viewer doesn't copy the components into successor states
+    if (DM::DataViewer * viewer = sys->getDataViewer(view.getName())) {
+        foreach (DM::Component * c, viewer->getComponentsReadOnly()) {
+            if (c->getType() == DM::NODE) {
+                nodes.push_back((DM::Node*)c);
+            } else if (c->getType() == DM::EDGE) {
+                nodes.push_back(((DM::Edge*)c)->getStartNode());
+                nodes.push_back(((DM::Edge*)c)->getEndNode());
+            } else if (c->getType() == DM::FACE) {
+                foreach (DM::Node * n, ((DM::Face*)c)->getNodePointers())
+                    nodes.push_back(n);
+            }
+        }
+    } else {
+        if (view.getType() == DM::NODE) TBVectorData::GetNodesFromNodes(sys, view, nodes);
+        if (view.getType() == DM::EDGE) TBVectorData::GetNodesFromEdges(sys, view, nodes);
+        if (view.getType() == DM::FACE) TBVectorData::GetNodesFromFaces(sys, view, nodes);
+    }
 
     if (nodes.size() < 2)  {
         DM::Logger(DM::Warning) << "Number of Nodes < 2 no bounding box created";
@@ -681,8 +697,8 @@ std::vector<DM::Node *> TBVectorData::GetNodesFromEdges(DM::System *sys, DM::Vie
     std::vector<std::string> uuids = sys->getUUIDs(view);
     foreach (std::string uuid, uuids) {
         DM::Edge * e = sys->getEdge(uuid);
-        nodes.push_back(sys->getNode(e->getStartpointName()));
-        nodes.push_back(sys->getNode(e->getEndpointName()));
+        nodes.push_back(e->getStartNode());
+        nodes.push_back(e->getEndNode());
     }
     return nodes;
 }
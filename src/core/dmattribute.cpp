@@ -27,7 +27,9 @@
 #include <dmmodule.h>
 #include <dmcomponent.h>
 #include <dmattribute.h>
+#include <dmattributecodec.h>
 #include <QVariant>
+#include <cstring>
 #include "dmdbconnector.h"
 #include "dmlogger.h"
 
@@ -58,120 +60,19 @@ void Attribute::PrintCacheStatistics()
 #endif
 }*/
 
-QByteArray GetBinaryValue(std::vector<double> v)
+template<typename T>
+T Decode(const QVariant& q)
 {
-	QByteArray bytes;
-	QDataStream s(&bytes, QIODevice::WriteOnly);
-	s << QVector<double>::fromStdVector(v);
-	return bytes;
-}
-
-QByteArray GetBinaryValue(std::vector<std::string> v)
-{
-	std::vector<QString> qv;
-	foreach(std::string item, v)
-		qv.push_back(QString::fromStdString(item));
-
-	QByteArray bytes;
-	QDataStream s(&bytes, QIODevice::WriteOnly);
-	s << QVector<QString>::fromStdVector(qv);
-	return bytes;
-}
-
-QByteArray GetBinaryValue(std::vector<LinkAttribute> v)
-{
-	QByteArray bytes;
-	QDataStream s(&bytes, QIODevice::WriteOnly);
-	s << (int)v.size();
-	foreach(LinkAttribute it, v)
-	{
-		s << QString::fromStdString(it.uuid);
-		s << QString::fromStdString(it.viewname);
-	}
-	return bytes;
-}
-
-QByteArray GetBinaryValue(TimeSeriesAttribute a)
-{
-	QByteArray bytes;
-	QDataStream s(&bytes, QIODevice::WriteOnly);
-	int size = a.timestamp.size();
-	s << size;
-	for(int i=0;i<size;i++)
-	{
-		s << QString::fromStdString(a.timestamp[i]);
-		s << a.value[i];
-	}
-	return bytes;
-}
-
-std::vector<LinkAttribute> ToLinkVector(QVariant q)
-{
-	std::vector<LinkAttribute> result;
-	QByteArray bytes = q.toByteArray();
-	QDataStream s(&bytes, QIODevice::ReadOnly);
-	int size;
-	s >> size;
-	QString uuid;
-	QString view;
-	LinkAttribute la;
-	for(int i=0;i<size;i++)
-	{
-		s >> uuid;
-		s >> view;
-		la.uuid = uuid.toStdString();
-		la.viewname = view.toStdString();
-		result.push_back(la);
-	}
-	return result;
-}
-
-std::vector<double> ToDoubleVector(QVariant q)
-{
-	QByteArray bytes = q.toByteArray();
-	QDataStream s(&bytes, QIODevice::ReadOnly);
-	QVector<double> v;
-	s >> v;
-	return v.toStdVector();
-}
-
-std::vector<std::string> ToStringVector(QVariant q)
-{
-	QByteArray bytes = q.toByteArray();
-	QDataStream s(&bytes, QIODevice::ReadOnly);
-	QVector<QString> qv;
-	s >> qv;
-	std::vector<std::string> sv;
-	foreach(QString qstr, qv)
-		sv.push_back(qstr.toStdString());
-
-	return sv;
-}
-
-TimeSeriesAttribute ToTimeSeriesAttribute(QVariant q)
-{
-	QByteArray bytes = q.toByteArray();
-	QDataStream s(&bytes, QIODevice::ReadOnly);
-	TimeSeriesAttribute ts;
-	int size;
-	s >> size;
-	for(int i=0;i<size;i++)
-	{
-		QString str;
-		s >> str;
-		double d;
-		s >> d;
-
-		ts.timestamp.push_back(str.toStdString());
-		ts.value.push_back(d);
-	}
-	return ts;
+	T value;
+	if(!AttributeCodec::Decode(q.toByteArray(), &value))
+		Logger(Error) << "attribute data of unknown format";
+	return value;
 }
 
 Attribute::AttributeValue::AttributeValue()
 {
-	ptr = NULL;
 	type = NOTYPE;
+	isShared = false;
 }
 
 Attribute::AttributeValue::~AttributeValue()
@@ -181,93 +82,127 @@ Attribute::AttributeValue::~AttributeValue()
 
 Attribute::AttributeValue::AttributeValue(const AttributeValue& ref)
 {
-	this->type = ref.type;
-	switch(ref.type)
+	CopyFrom(ref);
+}
+
+Attribute::AttributeValue& Attribute::AttributeValue::operator=(const AttributeValue& other)
+{
+	if(this != &other)
 	{
-	case NOTYPE:
-		ptr = NULL;
-		break;
-	case DOUBLE:
-		ptr = new double(*((double*)ref.ptr));
-		break;
-	case STRING:
-		ptr = new std::string(*((std::string*)ref.ptr));
-		break;
-	case TIMESERIES:
-		ptr = new TimeSeriesAttribute(*((TimeSeriesAttribute*)ref.ptr));
-		break;
-	case LINK:
-		//ptr = new LinkAttribute(*((LinkAttribute*)ref.ptr));
-		ptr = new std::vector<LinkAttribute>(*((std::vector<LinkAttribute>*)ref.ptr));
-		break;
-	case DOUBLEVECTOR:
-		ptr = new std::vector<double>(*((std::vector<double>*)ref.ptr));
-		break;
-	case STRINGVECTOR:
-		ptr = new std::vector<std::string>(*((std::vector<std::string>*)ref.ptr));
-		break;
-	default: 
-		type = NOTYPE;
-		ptr = NULL;
-		break;
+		Free();
+		CopyFrom(other);
 	}
+	return *this;
+}
+
+void Attribute::AttributeValue::CopyFrom(const AttributeValue& other)
+{
+	type = other.type;
+	isShared = other.isShared;
+	str = other.str;	// copies the whole union
+	if(isShared)
+		shared->ref.ref();
 }
 
 Attribute::AttributeValue::AttributeValue(QVariant var, AttributeType type)
 {
-	this->type = type;
+	this->type = NOTYPE;
+	isShared = false;
 	switch(type)
 	{
-	case NOTYPE:	ptr = NULL;
+	case DOUBLE:	setDouble(var.toDouble());
 		break;
-	case DOUBLE:	ptr = new double(var.toDouble());
+	case STRING:	setString(var.toString().toStdString());
 		break;
-	case STRING:	ptr = new std::string(var.toString().toStdString());
+	case TIMESERIES:setShared(TIMESERIES, Decode<TimeSeriesAttribute>(var));
 		break;
-	case TIMESERIES:ptr = new TimeSeriesAttribute(ToTimeSeriesAttribute(var));
+	case LINK:		setShared(LINK, Decode<std::vector<LinkAttribute> >(var));
 		break;
-	case LINK:		ptr = new std::vector<LinkAttribute>(ToLinkVector(var));
+	case DOUBLEVECTOR:	setShared(DOUBLEVECTOR, Decode<std::vector<double> >(var));
 		break;
-	case DOUBLEVECTOR:	ptr = new std::vector<double>(ToDoubleVector(var));
+	case STRINGVECTOR:	setShared(STRINGVECTOR, Decode<std::vector<std::string> >(var));
 		break;
-	case STRINGVECTOR:	ptr = new std::vector<std::string>(ToStringVector(var));
+	case NUMERICTIMESERIES:	setShared(NUMERICTIMESERIES, Decode<NumericTimeSeries>(var));
 		break;
-	default: ptr = NULL;
-		type = NOTYPE;
+	default:
 		break;
 	}
 }
 void Attribute::AttributeValue::Free()
 {
-	switch(type)
-	{
-	case DOUBLE:	delete (double*)ptr;
-		break;
-	case STRING:		delete (std::string*)ptr;
-		break;
-	case TIMESERIES:	delete (TimeSeriesAttribute*)ptr;
-		break;
-	case LINK:			delete (std::vector<LinkAttribute>*)ptr;
-		break;
-	case DOUBLEVECTOR:		delete (std::vector<double>*)ptr;
-		break;
-	case STRINGVECTOR:		delete (std::vector<std::string>*)ptr;
-		break;
-	default:
-		break;
-	}
-	ptr = NULL;
+	if(isShared && !shared->ref.deref())
+		delete shared;
+	isShared = false;
 	type = NOTYPE;
 }
 Attribute::AttributeValue::AttributeValue(double d)
 {
-	type = DOUBLE;
-	ptr = new double(d);
+	type = NOTYPE;
+	isShared = false;
+	setDouble(d);
 }
 Attribute::AttributeValue::AttributeValue(std::string string)
 {
+	type = NOTYPE;
+	isShared = false;
+	setString(string);
+}
+
+void Attribute::AttributeValue::setDouble(double d)
+{
+	Free();
+	type = DOUBLE;
+	this->d = d;
+}
+
+double Attribute::AttributeValue::getDouble() const
+{
+	return d;
+}
+
+void Attribute::AttributeValue::setString(const std::string& s)
+{
+	if(s.size() > ATTRIBUTEVALUE_INLINE_STRING)
+	{
+		setShared(STRING, s);
+		return;
+	}
+	Free();
 	type = STRING;
-	ptr = new std::string(string);
+	memcpy(str.chars, s.data(), s.size());
+	str.length = s.size();
+}
+
+std::string Attribute::AttributeValue::getString() const
+{
+	if(isShared)
+		return getShared<std::string>();
+	return std::string(str.chars, str.length);
+}
+
+bool Attribute::AttributeValue::equalsString(const std::string& s) const
+{
+	if(type != STRING)
+		return false;
+	if(isShared)
+		return getShared<std::string>() == s;
+	return s.size() == str.length && memcmp(str.chars, s.data(), str.length) == 0;
+}
+
+template<typename T>
+void Attribute::AttributeValue::setShared(AttributeType type, const T& value)
+{
+	SharedAttributeValue* newShared = new TypedAttributeValue<T>(value);
+	Free();
+	this->type = type;
+	isShared = true;
+	shared = newShared;
+}
+
+template<typename T>
+const T& Attribute::AttributeValue::getShared() const
+{
+	return static_cast<TypedAttributeValue<T>*>(shared)->value;
 }
 
 QVariant Attribute::AttributeValue::toQVariant()
@@ -275,12 +210,13 @@ QVariant Attribute::AttributeValue::toQVariant()
 	switch(type)
 	{
 	case NOTYPE:	return QVariant();
-	case DOUBLE:	return QVariant::fromValue(*(double*)ptr);
-	case STRING:	return QString::fromStdString(*(std::string*)ptr);
-	case TIMESERIES:return GetBinaryValue(*(TimeSeriesAttribute*)ptr);
-	case LINK:		return GetBinaryValue(*(std::vector<LinkAttribute>*)ptr);
-	case DOUBLEVECTOR:	return GetBinaryValue(*(std::vector<double>*)ptr);
-	case STRINGVECTOR:	return GetBinaryValue(*(std::vector<std::string>*)ptr);
+	case DOUBLE:	return QVariant::fromValue(getDouble());
+	case STRING:	return QString::fromStdString(getString());
+	case TIMESERIES:return AttributeCodec::Encode(getShared<TimeSeriesAttribute>());
+	case LINK:		return AttributeCodec::Encode(getShared<std::vector<LinkAttribute> >());
+	case DOUBLEVECTOR:	return AttributeCodec::Encode(getShared<std::vector<double> >());
+	case STRINGVECTOR:	return AttributeCodec::Encode(getShared<std::vector<std::string> >());
+	case NUMERICTIMESERIES:	return AttributeCodec::Encode(getShared<NumericTimeSeries>());
 	default:		return QVariant();
 	}
 }
@@ -288,7 +224,7 @@ QVariant Attribute::AttributeValue::toQVariant()
 Attribute::Attribute()
 {
 //	_uuid = QUuid::createUuid();
-	name="";
+	nameId = AttributeNames::GetId("");
 //	value = new AttributeValue();
 	owner = NULL;
 	isInserted = false;
@@ -298,7 +234,7 @@ Attribute::Attribute(const Attribute &newattribute):
 	value(newattribute.value)
 {
 //	_uuid = QUuid::createUuid();
-	name=newattribute.name;
+	nameId=newattribute.nameId;
 //	value = AttributeValue(newattribute.value);
 	owner = NULL;
 	isInserted = false;
@@ -307,7 +243,7 @@ Attribute::Attribute(const Attribute &newattribute):
 Attribute::Attribute(std::string name)
 {
 //	_uuid = QUuid::createUuid();
-	this->name=name;
+	nameId = AttributeNames::GetId(name);
 	owner = NULL;
 //	value = new AttributeValue();
 	isInserted = false;
@@ -318,7 +254,7 @@ Attribute::Attribute(std::string name, double val):
 	value(val)
 {
 //	_uuid = QUuid::createUuid();
-	this->name=name;
+	nameId = AttributeNames::GetId(name);
 	owner = NULL;
 	isInserted = false;
 //	value = new AttributeValue(val);
@@ -327,7 +263,7 @@ Attribute::Attribute(std::string name, std::string val):
 	value(val)
 {
 //	_uuid = QUuid::createUuid();
-	this->name=name;
+	nameId = AttributeNames::GetId(name);
 	owner = NULL;
 	isInserted = false;
 //	value = new AttributeValue(val);
@@ -336,7 +272,7 @@ Attribute::Attribute(std::string name, std::string val):
 Attribute::~Attribute()
 {
 	if(isInserted)
-		DBConnector::getInstance()->Delete("attributes", owner->getQUUID(), QString::fromStdString(name));
+		DBConnector::getInstance()->getBackend()->DeleteAttribute(owner->getQUUID(), QString::fromStdString(getName()));
 	/*if(value)
 		delete value;
 	else
@@ -348,7 +284,7 @@ Attribute& Attribute::operator=(const Attribute& other)
 {
 	if(this != &other)
 	{
-		name = other.name;
+		nameId = other.nameId;
 		this->value = other.value;
 	}
 	return *this;
@@ -361,72 +297,73 @@ Attribute::AttributeType Attribute::getType() const
 
 void Attribute::setName(std::string name)
 {
-	this->name=name;
+	nameId = AttributeNames::GetId(name);
 }
 
 std::string Attribute::getName() const
 {
-	return name;
+	return AttributeNames::GetName(nameId);
+}
+
+AttributeId Attribute::getNameId() const
+{
+	return nameId;
 }
 
 void Attribute::setDouble(double v)
 {
 	//AttributeValue* a = getValue();
-	value.Free();
-	//delete a->ptr;
-	value.type = DOUBLE;
-	value.ptr = new double(v);
+	value.setDouble(v);
 }
 
-double Attribute::getDouble()
+double Attribute::getDouble() const
 {
 //	AttributeValue* a = getValue();
-	if(value.type == DOUBLE)	return *((double*)value.ptr);
+	if(value.type == DOUBLE)	return value.getDouble();
 	return 0;
 }
 
 void Attribute::setString(std::string s)
 {
 //	AttributeValue* a = getValue();
-	value.Free();
-	value.type = STRING;
-	value.ptr = new std::string(s);
+	value.setString(s);
 }
 
 std::string Attribute::getString()
 {	
 	//AttributeValue* a = getValue();
-	if(value.type == STRING)	return *((std::string*)value.ptr);
+	if(value.type == STRING)	return value.getString();
 	return "";
 }
 
+bool Attribute::equalsString(const std::string& s) const
+{
+	return value.equalsString(s);
+}
+
 void Attribute::setDoubleVector(std::vector<double> v)
 {
 	//AttributeValue* a = getValue();
-	value.Free();
-	value.type = DOUBLEVECTOR;
-	value.ptr = new std::vector<double>(v);
+	value.setShared(DOUBLEVECTOR, v);
 }
 
 std::vector<double> Attribute::getDoubleVector()
 {
 	//AttributeValue* a = getValue();
-	if(value.type == DOUBLEVECTOR)	return *((std::vector<double>*)value.ptr);
+	if(value.type == DOUBLEVECTOR)	return value.getShared<std::vector<double> >();
 	return std::vector<double>();
 }
 
 void Attribute::setStringVector(std::vector<std::string> s)
 {
 	//AttributeValue* a = getValue();
-	value.Free();
-	value.type = STRINGVECTOR;
-	value.ptr = new std::vector<std::string>(s);
+	value.setShared(STRINGVECTOR, s);
 }
 
 std::vector<std::string> Attribute::getStringVector()
 {
 	//AttributeValue* a = getValue();
-	if(value.type == STRINGVECTOR)	return *((std::vector<std::string>*)value.ptr);
+	if(value.type == STRINGVECTOR)	return value.getShared<std::vector<std::string> >();
 	return std::vector<string>();
 }
 
@@ -468,23 +405,21 @@ void Attribute::setLink(string viewname, string uuid)
 void Attribute::setLinks(std::vector<LinkAttribute> links)
 {
 //	AttributeValue* a = getValue();
-	value.Free();
-	value.type = LINK;
-	value.ptr = new std::vector<LinkAttribute>(links);
+	value.setShared(LINK, links);
 }
 
 LinkAttribute Attribute::getLink()
 {
 	//AttributeValue* a = getValue();
-	if(value.type == LINK && (*((std::vector<LinkAttribute>*)value.ptr)).size() > 0)	
-		return (*((std::vector<LinkAttribute>*)value.ptr))[0];
+	if(value.type == LINK && value.getShared<std::vector<LinkAttribute> >().size() > 0)	
+		return value.getShared<std::vector<LinkAttribute> >()[0];
 	return LinkAttribute();
 }
 
 std::vector<LinkAttribute> Attribute::getLinks()
 {
 	//AttributeValue* a = getValue();
-	if(value.type == LINK)	return *((std::vector<LinkAttribute>*)value.ptr);
+	if(value.type == LINK)	return value.getShared<std::vector<LinkAttribute> >();
 	return std::vector<LinkAttribute>();
 }
 
@@ -496,9 +431,7 @@ void Attribute::addTimeSeries(std::vector<std::string> timestamp, std::vector<do
 		return;
 	}
 	//AttributeValue* a = getValue();
-	this->value.Free();
-	this->value.type = TIMESERIES;
-	this->value.ptr = new TimeSeriesAttribute(&timestamp, &value);
+	this->value.setShared(TIMESERIES, TimeSeriesAttribute(&timestamp, &value));
 }
 
 void Attribute::getTimeSeries(std::vector<std::string> *timestamp, std::vector<double> *value)
@@ -506,51 +439,173 @@ void Attribute::getTimeSeries(std::vector<std::string> *timestamp, std::vector<d
 	//AttributeValue* a = getValue();
 	if(this->value.type == TIMESERIES)	
 	{
-		*timestamp = ((TimeSeriesAttribute*)this->value.ptr)->timestamp;
-		*value = ((TimeSeriesAttribute*)this->value.ptr)->value;
+		*timestamp = this->value.getShared<TimeSeriesAttribute>().timestamp;
+		*value = this->value.getShared<TimeSeriesAttribute>().value;
+	}
+	else if(this->value.type == NUMERICTIMESERIES)
+	{
+		TimeSeriesAttribute ts = this->value.getShared<NumericTimeSeries>().ToStrings();
+		*timestamp = ts.timestamp;
+		*value = ts.value;
+	}
+}
+
+void Attribute::setTimeSeries(const std::vector<double>& times, const std::vector<double>& values)
+{
+	if(times.size()!=values.size())
+	{
+		DM::Logger(DM::Error) << "Length of time and value vector are not equal";
+		return;
+	}
+	value.setShared(NUMERICTIMESERIES, NumericTimeSeries(times, values));
+}
+
+TimeSeriesSpan Attribute::getTimeSeriesSpan()
+{
+	if(value.type == NUMERICTIMESERIES)
+	{
+		SharedAttributeValue* series = value.getSharedValue();
+		series->ref.ref();
+		return TimeSeriesSpan(series);
+	}
+	NumericTimeSeries converted;
+	if(value.type == TIMESERIES && NumericTimeSeries::FromStrings(value.getShared<TimeSeriesAttribute>(), &converted))
+		return TimeSeriesSpan(new TypedAttributeValue<NumericTimeSeries>(converted));
+	return TimeSeriesSpan();
+}
+
+bool Attribute::toNumericTimeSeries()
+{
+	if(value.type == NUMERICTIMESERIES)
+		return true;
+	NumericTimeSeries converted;
+	if(value.type != TIMESERIES || !NumericTimeSeries::FromStrings(value.getShared<TimeSeriesAttribute>(), &converted))
+		return false;
+	value.setShared(NUMERICTIMESERIES, converted);
+	return true;
+}
+
+bool NumericTimeSeries::FromStrings(const TimeSeriesAttribute& ts, NumericTimeSeries* result)
+{
+	result->times.resize(ts.timestamp.size());
+	for(unsigned int i=0;i<ts.timestamp.size();i++)
+	{
+		QString s = QString::fromStdString(ts.timestamp[i]).trimmed();
+		bool ok;
+		double seconds = s.toDouble(&ok);
+		if(!ok)
+		{
+			QDateTime date = QDateTime::fromString(s, "yyyy-MM-dd hh:mm:ss");
+			if(!date.isValid())
+				date = QDateTime::fromString(s, Qt::ISODate);
+			if(!date.isValid())
+			{
+				result->times.clear();
+				return false;
+			}
+			date.setTimeSpec(Qt::UTC);
+			seconds = date.toMSecsSinceEpoch() / 1000.0;
+		}
+		result->times[i] = seconds;
 	}
+	result->values = ts.value;
+	return true;
+}
+
+TimeSeriesAttribute NumericTimeSeries::ToStrings() const
+{
+	TimeSeriesAttribute ts;
+	ts.value = values;
+	ts.timestamp.reserve(times.size());
+	foreach(double seconds, times)
+	{
+		qint64 msecs = qRound64(seconds*1000);
+		QDateTime date = QDateTime::fromMSecsSinceEpoch(msecs).toUTC();
+		ts.timestamp.push_back(date.toString(msecs % 1000 ? "yyyy-MM-dd hh:mm:ss.zzz" : "yyyy-MM-dd hh:mm:ss").toStdString());
+	}
+	return ts;
+}
+
+TimeSeriesSpan::TimeSeriesSpan()
+{
+	series = NULL;
+	times = values = NULL;
+	count = 0;
+}
+
+TimeSeriesSpan::TimeSeriesSpan(SharedAttributeValue* series)
+{
+	this->series = series;
+	const NumericTimeSeries& ts = static_cast<TypedAttributeValue<NumericTimeSeries>*>(series)->value;
+	count = ts.times.size();
+	times = count ? &ts.times[0] : NULL;
+	values = count ? &ts.values[0] : NULL;
+}
+
+TimeSeriesSpan::TimeSeriesSpan(const TimeSeriesSpan& other)
+{
+	series = other.series;
+	times = other.times;
+	values = other.values;
+	count = other.count;
+	if(series)
+		series->ref.ref();
+}
+
+TimeSeriesSpan& TimeSeriesSpan::operator=(const TimeSeriesSpan& other)
+{
+	if(other.series)
+		other.series->ref.ref();
+	if(series && !series->ref.deref())
+		delete series;
+	series = other.series;
+	times = other.times;
+	values = other.values;
+	count = other.count;
+	return *this;
+}
+
+TimeSeriesSpan::~TimeSeriesSpan()
+{
+	if(series && !series->ref.deref())
+		delete series;
 }
 
 void Attribute::setType(AttributeType type)
 {
 	//AttributeValue* a = getValue();
-	value.Free();
-	value.type = type;
 	switch(type)
 	{
-	case NOTYPE:
-		value.ptr = NULL;
-		break;
 	case DOUBLE:
-		value.ptr = new double(0);
+		value.setDouble(0);
 		break;
 	case STRING:
-		value.ptr = new std::string();
+		value.setString("");
 		break;
 	case TIMESERIES:
-		value.ptr = new TimeSeriesAttribute();
+		value.setShared(TIMESERIES, TimeSeriesAttribute());
 		break;
 	case LINK:
-		value.ptr = new std::vector<LinkAttribute>();
+		value.setShared(LINK, std::vector<LinkAttribute>());
 		break;
 	case DOUBLEVECTOR:
-		value.ptr = new std::vector<double>();
+		value.setShared(DOUBLEVECTOR, std::vector<double>());
 		break;
 	case STRINGVECTOR:
-		value.ptr = new std::vector<std::string>();
+		value.setShared(STRINGVECTOR, std::vector<std::string>());
 		break;
-	default: value.ptr = NULL;
-		value.type = NOTYPE;
+	case NUMERICTIMESERIES:
+		value.setShared(NUMERICTIMESERIES, NumericTimeSeries());
+		break;
+	default:
+		value.Free();
 		break;
 	}
 }
 void Attribute::Change(const Attribute &attribute)
 {
 	//name = attribute.name; name should never be changed!
-	value.Free();
-	AttributeValue* val = new AttributeValue(attribute.value);
-	value = *val;
-	val->ptr = NULL;
+	value = attribute.value;
 
 	/*AttributeValue* newValue = new AttributeValue(*attribute.value);
 	if(value)
@@ -579,7 +634,8 @@ const char *Attribute::getTypeName(Attribute::AttributeType type)
 		"TIMESERIES",
 		"LINK",
 		"DOUBLEVECTOR",
-		"STRINGVECTOR"
+		"STRINGVECTOR",
+		"NUMERICTIMESERIES"
 	};
 	return arr[type];
 }
@@ -645,43 +701,48 @@ void Attribute::SaveToDb(Attribute::AttributeValue *val)
 
 Attribute* Attribute::LoadAttribute(Component* c, const std::string& attributeName)
 {
-	QVariant t,v;
-	DBConnector::getInstance()->Select("attributes", c->getQUUID(), QString::fromStdString(attributeName),
-		"type",     &t,
-		"value",     &v);
+	int t;
+	QVariant v;
+	DBConnector::getInstance()->getBackend()->LoadAttribute(c->getQUUID(), QString::fromStdString(attributeName), &t, &v);
 
 	Attribute* a = new Attribute(attributeName);
 	a->setOwner(c);
 	a->isInserted = true;
 
-	AttributeValue* val = new AttributeValue(v,(AttributeType)t.toInt());
-	a->value = *val;
-	val->ptr = NULL;
+	a->value = AttributeValue(v,(AttributeType)t);
 	return a;
 }
 
-void Attribute::SaveAttribute(Attribute* a)
+void Attribute::LoadAttributes(const std::vector<Component*>& owners, const std::string& attributeName,
+							   std::vector<Attribute*>& result)
 {
-	if(!a || !a->owner)
-		return;
-	
-	QVariant qval = a->value.toQVariant();
-	QVariant qtype = QVariant::fromValue((int)a->value.type);
-	QString qname = QString::fromStdString(a->name);
+	QList<QUuid> keys;
+	foreach(Component* c, owners)
+		keys.append(c->getQUUID());
 
-	if(a->isInserted)
-	{
-		DBConnector::getInstance()->Update(
-			"attributes",	a->owner->getQUUID(), qname,
-			"type",			&qtype,
-			"value",		&qval);
-	}
-	else
+	QList<int> types;
+	QList<QVariant> values;
+	DBConnector::getInstance()->getBackend()->LoadAttributes(keys, QString::fromStdString(attributeName),
+		&types, &values);
+
+	result.clear();
+	for(unsigned int i=0;i<owners.size();i++)
 	{
-		DBConnector::getInstance()->Insert(
-			"attributes",	a->owner->getQUUID(), qname,
-			"type",			&qtype,
-			"value",		&qval);
+		Attribute* a = new Attribute(attributeName);
+		a->setOwner(owners[i]);
 		a->isInserted = true;
+
+		a->value = AttributeValue(values[i], (AttributeType)types[i]);
+		result.push_back(a);
 	}
 }
+
+void Attribute::SaveAttribute(Attribute* a)
+{
+	if(!a || !a->owner)
+		return;
+	
+	DBConnector::getInstance()->getBackend()->SaveAttribute(a->owner->getQUUID(), QString::fromStdString(a->getName()),
+		(int)a->value.type, a->value.toQVariant(), a->isInserted);
+	a->isInserted = true;
+}
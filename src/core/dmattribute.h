@@ -32,6 +32,7 @@
 #include <set>
 #include <map>
 #include <dmcompilersettings.h>
+#include <dmattributelist.h>
 #include <QtCore>
 #include "dmdbconnector.h"
 #include <dmdbcache.h>
@@ -65,8 +66,77 @@ public:
 	std::vector<double> value;
 };
 
+/** @brief time series with numeric timestamps, seconds since 1970-01-01 00:00:00 UTC.
+* Timestamps and values are kept in two contiguous arrays. */
+class DM_HELPER_DLL_EXPORT NumericTimeSeries
+{
+public:
+	NumericTimeSeries() {}
+	NumericTimeSeries(const std::vector<double>& times, const std::vector<double>& values)
+		: times(times), values(values) {}
+	std::vector<double> times;
+	std::vector<double> values;
+
+	/** @brief converts a string time series, timestamps are either numbers or dates like
+	* "yyyy-MM-dd hh:mm:ss" or ISO 8601, taken as UTC. Returns false if a timestamp can't be parsed */
+	static bool FromStrings(const TimeSeriesAttribute& ts, NumericTimeSeries* result);
+	/** @brief converts to a string time series with timestamps formatted as "yyyy-MM-dd hh:mm:ss[.zzz]" UTC */
+	TimeSeriesAttribute ToStrings() const;
+};
+
 class Component;
 
+// strings up to this length are stored inside of the attribute value without a heap allocation
+#define ATTRIBUTEVALUE_INLINE_STRING 15
+
+/** @brief reference counted attribute value, shared by all copies of an attribute value
+* @internal */
+class SharedAttributeValue
+{
+public:
+	SharedAttributeValue(): ref(1) {}
+	virtual ~SharedAttributeValue() {}
+	QAtomicInt ref;
+};
+
+template<typename T>
+class TypedAttributeValue: public SharedAttributeValue
+{
+public:
+	TypedAttributeValue(const T& value): value(value) {}
+	T value;
+};
+
+/** @brief read only view of a numeric time series, see Attribute::getTimeSeriesSpan.
+* The span shares the series with the attribute instead of copying it. It keeps the series
+* alive, so it stays valid if the attribute is changed or deleted. */
+class DM_HELPER_DLL_EXPORT TimeSeriesSpan
+{
+public:
+	TimeSeriesSpan();
+	TimeSeriesSpan(const TimeSeriesSpan& other);
+	TimeSeriesSpan& operator=(const TimeSeriesSpan& other);
+	~TimeSeriesSpan();
+
+	size_t size() const {return count;}
+	bool empty() const {return count == 0;}
+	double time(size_t i) const {return times[i];}
+	double value(size_t i) const {return values[i];}
+	//!< contiguous timestamps, NULL if empty
+	const double* timeData() const {return times;}
+	//!< contiguous values, NULL if empty
+	const double* valueData() const {return values;}
+private:
+	friend class Attribute;
+	//!< takes over a reference of a shared NumericTimeSeries
+	TimeSeriesSpan(SharedAttributeValue* series);
+
+	SharedAttributeValue*	series;
+	const double*	times;
+	const double*	values;
+	size_t			count;
+};
+
 /** @ingroup DynaMind-Core
 * An Attribute is used to add informations to an object.
 *
@@ -83,8 +153,14 @@ public:
 		TIMESERIES,
 		LINK,
 		DOUBLEVECTOR,
-		STRINGVECTOR
+		STRINGVECTOR,
+		NUMERICTIMESERIES
 	};
+	/** @brief tagged union of the attribute types
+	*
+	* Doubles and short strings are stored inline. Long strings, vectors and
+	* time series are kept in a reference counted SharedAttributeValue, copies
+	* share it. Shared values are never changed, setting a value replaces it. */
 	class AttributeValue
 	{
 	public:
@@ -93,12 +169,38 @@ public:
 		AttributeValue(double d);
 		AttributeValue(std::string string);
 		~AttributeValue();
+		AttributeValue& operator=(const AttributeValue& other);
 		void Free();
 		AttributeValue(QVariant var, AttributeType type);
 		QVariant toQVariant();
+
+		void setDouble(double d);
+		double getDouble() const;
+		void setString(const std::string& s);
+		std::string getString() const;
+		//!< compares a string value without copying it
+		bool equalsString(const std::string& s) const;
+		//!< sets a value of a shared type: TIMESERIES, LINK, DOUBLEVECTOR, STRINGVECTOR or NUMERICTIMESERIES
+		template<typename T> void setShared(AttributeType type, const T& value);
+		template<typename T> const T& getShared() const;
+		//!< the shared value, NULL for inline values
+		SharedAttributeValue* getSharedValue() const {return isShared ? shared : NULL;}
 		
 		Attribute::AttributeType type;
-		void*	ptr;
+	private:
+		void CopyFrom(const AttributeValue& other);
+
+		bool	isShared;
+		union
+		{
+			double					d;
+			SharedAttributeValue*	shared;
+			struct
+			{
+				char			chars[ATTRIBUTEVALUE_INLINE_STRING];
+				unsigned char	length;
+			} str;
+		};
 	};
 
 	/** @brief =operator */
@@ -131,11 +233,13 @@ public:
 	/** @brief set double value**/
 	void setDouble(double v);
 	/** @brief get double value**/
-	double getDouble();
+	double getDouble() const;
 	/** @brief set string value**/
 	void setString(std::string s);
 	/** @brief get string value**/
 	std::string getString();
+	/** @brief returns true if this is a string attribute with the given value, the string is not copied **/
+	bool equalsString(const std::string& s) const;
 	/** @brief set double vector**/
 	void setDoubleVector(std::vector<double> v);
 	/** @brief get double vector**/
@@ -148,6 +252,8 @@ public:
 	void setName(std::string name);
 	/** @brief get name */
 	std::string getName() const;
+	/** @brief get the interned name, see AttributeNames */
+	AttributeId getNameId() const;
 	/** @brief destructor */
 	~Attribute();
 	/** @brief return datatype*/
@@ -162,8 +268,15 @@ public:
 	std::vector<LinkAttribute> getLinks();
 	/** @brief add TimeSeries **/
 	void addTimeSeries(std::vector<std::string> timestamp, std::vector<double> value);
-	/** @brief add TimeSeries **/
+	/** @brief get TimeSeries, timestamps of a numeric time series are formatted, see NumericTimeSeries::ToStrings **/
 	void getTimeSeries(std::vector<std::string> *timestamp, std::vector<double> *value);
+	/** @brief set a time series with numeric timestamps, see NumericTimeSeries **/
+	void setTimeSeries(const std::vector<double>& times, const std::vector<double>& values);
+	/** @brief returns the numeric time series without copying it. A string time series is
+	* converted, the span is empty if the type doesn't fit or a timestamp can't be parsed **/
+	TimeSeriesSpan getTimeSeriesSpan();
+	/** @brief converts a string time series to a numeric one, returns false if it isn't possible **/
+	bool toNumericTimeSeries();
 	/** @brief Sets attribute type */
 	void setType(AttributeType type);
 	/**
@@ -195,12 +308,15 @@ public:
 	static void ClearCache();*/
 	
 	static Attribute* LoadAttribute(Component* c, const std::string& attributeName);
+	/** @brief loads the attribute of all given owners with bulk selects, result[i] belongs to owners[i] */
+	static void LoadAttributes(const std::vector<Component*>& owners, const std::string& attributeName,
+		std::vector<Attribute*>& result);
 	static void SaveAttribute(Attribute* a);
 
 private:
 	//AttributeValue*	getValue() const;
 
-	std::string		name;
+	AttributeId		nameId;
 	Component*		owner;
 	AttributeValue	value;
 	bool			isInserted;
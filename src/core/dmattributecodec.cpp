@@ -0,0 +1,422 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#include <dmattributecodec.h>
+#include <cstring>
+
+using namespace DM;
+
+enum
+{
+	CODEC_COMPRESSED = 1	// flag: payload is a compressed block
+};
+
+// writes the payload of an encoded value
+class CodecWriter
+{
+public:
+	CodecWriter(int reserve)
+	{
+		bytes.reserve(reserve + 2);
+		bytes.append((char)ATTRIBUTECODEC_VERSION);
+		bytes.append((char)0);
+	}
+	void WriteInt(unsigned int i)
+	{
+		char b[4] = {(char)i, (char)(i >> 8), (char)(i >> 16), (char)(i >> 24)};
+		bytes.append(b, 4);
+	}
+	void WriteString(const std::string& s)
+	{
+		WriteInt(s.size());
+		bytes.append(s.data(), s.size());
+	}
+	void WriteDoubles(const std::vector<double>& v)
+	{
+		WriteInt(v.size());
+		if(v.empty())
+			return;
+		int pos = bytes.size();
+		bytes.resize(pos + v.size()*sizeof(double));
+		char* dst = bytes.data() + pos;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		memcpy(dst, &v[0], v.size()*sizeof(double));
+#else
+		for(unsigned int i=0;i<v.size();i++)
+		{
+			const char* src = (const char*)&v[i];
+			for(int k=0;k<8;k++)
+				dst[i*8+k] = src[7-k];
+		}
+#endif
+	}
+	// compresses the payload if it gets smaller
+	QByteArray Finish(bool compress)
+	{
+		int payload = bytes.size() - 2;
+		if(!compress || payload <= ATTRIBUTECODEC_COMPRESSION_THRESHOLD)
+			return bytes;
+
+		QByteArray block = AttributeCodec::Compress(bytes.constData() + 2, payload);
+		if(block.size() + 4 >= payload)
+			return bytes;
+
+		CodecWriter compressed(block.size() + 4);
+		compressed.bytes[1] = (char)CODEC_COMPRESSED;
+		compressed.WriteInt(payload);
+		compressed.bytes.append(block);
+		return compressed.bytes;
+	}
+
+	QByteArray bytes;
+};
+
+// reads the payload of an encoded value, all reads fail after the first error
+class CodecReader
+{
+public:
+	CodecReader(const QByteArray& data)
+	{
+		ok = data.size() >= 2 && data[0] == (char)ATTRIBUTECODEC_VERSION;
+		if(ok && (data[1] & CODEC_COMPRESSED))
+		{
+			CodecReader header(data.constData() + 2, data.size() - 2);
+			unsigned int size = header.ReadInt();
+			ok = header.ok && size <= ATTRIBUTECODEC_MAX_SIZE
+				&& AttributeCodec::Decompress(header.pos, header.end - header.pos, (int)size, &buffer);
+			pos = buffer.constData();
+			end = pos + buffer.size();
+		}
+		else
+		{
+			pos = data.constData() + 2;
+			end = data.constData() + data.size();
+		}
+		if(!ok)
+			pos = end = NULL;
+	}
+	bool Check(unsigned int bytes)
+	{
+		ok = ok && (unsigned int)(end - pos) >= bytes;
+		return ok;
+	}
+	unsigned int ReadInt()
+	{
+		if(!Check(4))
+			return 0;
+		const unsigned char* b = (const unsigned char*)pos;
+		pos += 4;
+		return b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+	}
+	// reads a count of elements needing at least elementSize bytes each
+	unsigned int ReadCount(unsigned int elementSize)
+	{
+		unsigned int count = ReadInt();
+		if(ok && (qint64)count*elementSize > end - pos)
+			ok = false;
+		return ok ? count : 0;
+	}
+	std::string ReadString()
+	{
+		unsigned int size = ReadInt();
+		if(!Check(size))
+			return std::string();
+		std::string s(pos, size);
+		pos += size;
+		return s;
+	}
+	void ReadDoubles(std::vector<double>* v)
+	{
+		unsigned int count = ReadCount(sizeof(double));
+		v->resize(count);
+		if(!count)
+			return;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		memcpy(&(*v)[0], pos, count*sizeof(double));
+#else
+		for(unsigned int i=0;i<count;i++)
+		{
+			char* dst = (char*)&(*v)[i];
+			for(int k=0;k<8;k++)
+				dst[k] = pos[i*8+7-k];
+		}
+#endif
+		pos += count*sizeof(double);
+	}
+
+	bool ok;
+private:
+	CodecReader(const char* data, int size)
+	{
+		ok = true;
+		pos = data;
+		end = data + size;
+	}
+
+	QByteArray buffer;
+	const char* pos;
+	const char* end;
+};
+
+QByteArray AttributeCodec::Encode(const std::vector<double>& value)
+{
+	CodecWriter w(4 + value.size()*sizeof(double));
+	w.WriteDoubles(value);
+	return w.Finish(false);
+}
+
+QByteArray AttributeCodec::Encode(const std::vector<std::string>& value)
+{
+	CodecWriter w(4 + value.size()*16);
+	w.WriteInt(value.size());
+	for(unsigned int i=0;i<value.size();i++)
+		w.WriteString(value[i]);
+	return w.Finish(false);
+}
+
+QByteArray AttributeCodec::Encode(const std::vector<LinkAttribute>& value)
+{
+	CodecWriter w(4 + value.size()*64);
+	w.WriteInt(value.size());
+	for(unsigned int i=0;i<value.size();i++)
+	{
+		w.WriteString(value[i].uuid);
+		w.WriteString(value[i].viewname);
+	}
+	return w.Finish(false);
+}
+
+QByteArray AttributeCodec::Encode(const TimeSeriesAttribute& value)
+{
+	CodecWriter w(8 + value.timestamp.size()*32);
+	w.WriteInt(value.timestamp.size());
+	for(unsigned int i=0;i<value.timestamp.size();i++)
+		w.WriteString(value.timestamp[i]);
+	w.WriteDoubles(value.value);
+	return w.Finish(true);
+}
+
+QByteArray AttributeCodec::Encode(const NumericTimeSeries& value)
+{
+	CodecWriter w(8 + value.times.size()*2*sizeof(double));
+	w.WriteDoubles(value.times);
+	w.WriteDoubles(value.values);
+	return w.Finish(false);
+}
+
+bool AttributeCodec::Decode(const QByteArray& data, std::vector<double>* value)
+{
+	CodecReader r(data);
+	r.ReadDoubles(value);
+	if(!r.ok)
+		value->clear();
+	return r.ok;
+}
+
+bool AttributeCodec::Decode(const QByteArray& data, std::vector<std::string>* value)
+{
+	CodecReader r(data);
+	unsigned int count = r.ReadCount(4);
+	value->resize(count);
+	for(unsigned int i=0;i<count && r.ok;i++)
+		(*value)[i] = r.ReadString();
+	if(!r.ok)
+		value->clear();
+	return r.ok;
+}
+
+bool AttributeCodec::Decode(const QByteArray& data, std::vector<LinkAttribute>* value)
+{
+	CodecReader r(data);
+	unsigned int count = r.ReadCount(8);
+	value->resize(count);
+	for(unsigned int i=0;i<count && r.ok;i++)
+	{
+		(*value)[i].uuid = r.ReadString();
+		(*value)[i].viewname = r.ReadString();
+	}
+	if(!r.ok)
+		value->clear();
+	return r.ok;
+}
+
+bool AttributeCodec::Decode(const QByteArray& data, TimeSeriesAttribute* value)
+{
+	CodecReader r(data);
+	unsigned int count = r.ReadCount(4);
+	value->timestamp.resize(count);
+	for(unsigned int i=0;i<count && r.ok;i++)
+		value->timestamp[i] = r.ReadString();
+	r.ReadDoubles(&value->value);
+	if(r.ok && value->value.size() != count)
+		r.ok = false;
+	if(!r.ok)
+	{
+		value->timestamp.clear();
+		value->value.clear();
+	}
+	return r.ok;
+}
+
+bool AttributeCodec::Decode(const QByteArray& data, NumericTimeSeries* value)
+{
+	CodecReader r(data);
+	r.ReadDoubles(&value->times);
+	r.ReadDoubles(&value->values);
+	if(r.ok && value->values.size() != value->times.size())
+		r.ok = false;
+	if(!r.ok)
+	{
+		value->times.clear();
+		value->values.clear();
+	}
+	return r.ok;
+}
+
+// LZ77 block format: a sequence is a token byte (high nibble literal count,
+// low nibble match length - 4, 15 means more length bytes follow), the extra
+// literal length bytes, the literals, a 2 byte offset and the extra match
+// length bytes. The last sequence has literals only.
+
+#define CODEC_MIN_MATCH 4
+#define CODEC_HASH_BITS 12
+#define CODEC_MAX_OFFSET 65535
+
+static inline unsigned int Read32(const char* p)
+{
+	unsigned int v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline unsigned int HashOf(unsigned int v)
+{
+	return (v * 2654435761u) >> (32 - CODEC_HASH_BITS);
+}
+
+static void WriteLength(QByteArray* out, int length)
+{
+	for(; length >= 255; length -= 255)
+		out->append((char)255);
+	out->append((char)length);
+}
+
+static void WriteSequence(QByteArray* out, const char* literals, int literalCount, int offset, int matchLength)
+{
+	int m = offset ? matchLength - CODEC_MIN_MATCH : 0;
+	out->append((char)(((literalCount < 15 ? literalCount : 15) << 4) | (m < 15 ? m : 15)));
+	if(literalCount >= 15)
+		WriteLength(out, literalCount - 15);
+	out->append(literals, literalCount);
+	if(!offset)
+		return;
+	out->append((char)offset);
+	out->append((char)(offset >> 8));
+	if(m >= 15)
+		WriteLength(out, m - 15);
+}
+
+QByteArray AttributeCodec::Compress(const char* data, int size)
+{
+	QByteArray out;
+	out.reserve(size/2 + 16);
+	std::vector<int> table(1 << CODEC_HASH_BITS, -1);
+
+	int pos = 0;
+	int anchor = 0;
+	while(pos + CODEC_MIN_MATCH <= size)
+	{
+		unsigned int v = Read32(data + pos);
+		int& slot = table[HashOf(v)];
+		int ref = slot;
+		slot = pos;
+		if(ref < 0 || pos - ref > CODEC_MAX_OFFSET || Read32(data + ref) != v)
+		{
+			pos++;
+			continue;
+		}
+		int length = CODEC_MIN_MATCH;
+		while(pos + length < size && data[ref + length] == data[pos + length])
+			length++;
+		WriteSequence(&out, data + anchor, pos - anchor, pos - ref, length);
+		pos += length;
+		anchor = pos;
+	}
+	WriteSequence(&out, data + anchor, size - anchor, 0, 0);
+	return out;
+}
+
+static bool ReadLength(const unsigned char*& in, const unsigned char* end, int* length)
+{
+	unsigned char b;
+	do
+	{
+		if(in >= end)
+			return false;
+		b = *in++;
+		*length += b;
+	}
+	while(b == 255);
+	return true;
+}
+
+bool AttributeCodec::Decompress(const char* data, int length, int size, QByteArray* result)
+{
+	// each input byte yields at most 255 output bytes, the size is read from untrusted data
+	if(length < 0 || size < 0 || size > ATTRIBUTECODEC_MAX_SIZE || (qint64)size > (qint64)length*255 + 16)
+		return false;
+	result->resize(size);
+	char* out = result->data();
+	int pos = 0;
+	const unsigned char* in = (const unsigned char*)data;
+	const unsigned char* end = in + length;
+	while(in < end)
+	{
+		unsigned char token = *in++;
+		int literals = token >> 4;
+		if(literals == 15 && !ReadLength(in, end, &literals))
+			return false;
+		if(literals > end - in || literals > size - pos)
+			return false;
+		memcpy(out + pos, in, literals);
+		in += literals;
+		pos += literals;
+		if(in == end)
+			break;
+
+		if(end - in < 2)
+			return false;
+		int offset = in[0] | (in[1] << 8);
+		in += 2;
+		int match = token & 15;
+		if(match == 15 && !ReadLength(in, end, &match))
+			return false;
+		match += CODEC_MIN_MATCH;
+		if(offset == 0 || offset > pos || match > size - pos)
+			return false;
+		// byte by byte, the match may overlap the output
+		for(int i=0;i<match;i++, pos++)
+			out[pos] = out[pos - offset];
+	}
+	return pos == size;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#ifndef DMATTRIBUTECODEC_H
+#define DMATTRIBUTECODEC_H
+
+#include <dmcompilersettings.h>
+#include <dmattribute.h>
+#include <QByteArray>
+#include <vector>
+#include <string>
+
+namespace DM {
+
+// version of the encoded attribute format, stored in the first byte
+#define ATTRIBUTECODEC_VERSION 1
+
+// encoded time series bigger than this are compressed, if it pays off
+#define ATTRIBUTECODEC_COMPRESSION_THRESHOLD 256
+
+// decompressed payloads bigger than this are treated as corrupt
+#define ATTRIBUTECODEC_MAX_SIZE (256*1024*1024)
+
+/**************************************************************//**
+@class DM::AttributeCodec
+@ingroup DynaMind-Core
+@brief Binary format of vector, link and time series attributes
+moved to the db
+
+COMMENTS
+An encoded value starts with the format version and a flag byte,
+followed by the payload. Counts and lengths are little endian 32 bit
+integers, doubles are raw little endian IEEE 754 values, strings are
+length prefixed bytes. Time series are compressed with a simple LZ77
+block format (4 byte minimum match, 64 KB window), as their
+timestamps repeat a lot.
+Decode returns false and leaves the result empty on data of another
+version or on truncated data.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT AttributeCodec
+{
+public:
+	static QByteArray Encode(const std::vector<double>& value);
+	static QByteArray Encode(const std::vector<std::string>& value);
+	static QByteArray Encode(const std::vector<LinkAttribute>& value);
+	static QByteArray Encode(const TimeSeriesAttribute& value);
+	static QByteArray Encode(const NumericTimeSeries& value);
+
+	static bool Decode(const QByteArray& data, std::vector<double>* value);
+	static bool Decode(const QByteArray& data, std::vector<std::string>* value);
+	static bool Decode(const QByteArray& data, std::vector<LinkAttribute>* value);
+	static bool Decode(const QByteArray& data, TimeSeriesAttribute* value);
+	static bool Decode(const QByteArray& data, NumericTimeSeries* value);
+
+	//!< compresses the data in LZ77 block format
+	static QByteArray Compress(const char* data, int size);
+	//!< decompresses a block of Compress to exactly size bytes, returns false on malformed data.
+	// Sizes the block cannot expand to are rejected before allocating
+	static bool Decompress(const char* data, int length, int size, QByteArray* result);
+};
+
+}	// namespace DM
+
+#endif // DMATTRIBUTECODEC_H
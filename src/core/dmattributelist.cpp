@@ -0,0 +1,161 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#include <dmattributelist.h>
+#include <map>
+#include <deque>
+#include <cstring>
+#include <QReadWriteLock>
+
+using namespace DM;
+
+// names are kept in a deque, references to them stay valid while the table grows
+static QReadWriteLock attributeNamesLock;
+static std::map<std::string, AttributeId> attributeNameIds;
+static std::deque<std::string> attributeNames;
+
+AttributeId AttributeNames::GetId(const std::string& name)
+{
+	AttributeId id;
+	if(FindId(name, &id))
+		return id;
+
+	QWriteLocker wl(&attributeNamesLock);
+	// another thread may have added the name in the meantime
+	std::map<std::string, AttributeId>::const_iterator it = attributeNameIds.find(name);
+	if(it != attributeNameIds.end())
+		return it->second;
+
+	id = attributeNames.size();
+	attributeNames.push_back(name);
+	attributeNameIds[name] = id;
+	return id;
+}
+
+bool AttributeNames::FindId(const std::string& name, AttributeId* id)
+{
+	QReadLocker rl(&attributeNamesLock);
+	std::map<std::string, AttributeId>::const_iterator it = attributeNameIds.find(name);
+	if(it == attributeNameIds.end())
+		return false;
+	*id = it->second;
+	return true;
+}
+
+const std::string& AttributeNames::GetName(AttributeId id)
+{
+	QReadLocker rl(&attributeNamesLock);
+	return attributeNames[id];
+}
+
+unsigned int AttributeNames::Count()
+{
+	QReadLocker rl(&attributeNamesLock);
+	return attributeNames.size();
+}
+
+AttributeList::AttributeList()
+{
+	entries = inlineEntries;
+	count = 0;
+	capacity = ATTRIBUTELIST_INLINE_SIZE;
+}
+
+AttributeList::AttributeList(const AttributeList& other)
+{
+	entries = inlineEntries;
+	count = 0;
+	capacity = ATTRIBUTELIST_INLINE_SIZE;
+	*this = other;
+}
+
+AttributeList& AttributeList::operator=(const AttributeList& other)
+{
+	if(this != &other)
+	{
+		reserve(other.count);
+		memcpy(entries, other.entries, other.count*sizeof(Entry));
+		count = other.count;
+	}
+	return *this;
+}
+
+AttributeList::~AttributeList()
+{
+	if(entries != inlineEntries)
+		delete[] entries;
+}
+
+void AttributeList::reserve(unsigned int size)
+{
+	if(size <= capacity)
+		return;
+
+	unsigned int newCapacity = capacity;
+	while(newCapacity < size)
+		newCapacity *= 2;
+
+	Entry* newEntries = new Entry[newCapacity];
+	memcpy(newEntries, entries, count*sizeof(Entry));
+	if(entries != inlineEntries)
+		delete[] entries;
+	entries = newEntries;
+	capacity = newCapacity;
+}
+
+Attribute*& AttributeList::operator[](AttributeId id)
+{
+	Attribute** slot = find(id);
+	if(slot)
+		return *slot;
+
+	reserve(count + 1);
+	Entry& e = entries[count++];
+	e.id = id;
+	e.attribute = NULL;
+	return e.attribute;
+}
+
+bool AttributeList::remove(AttributeId id)
+{
+	for(unsigned int i=0;i<count;i++)
+	{
+		if(entries[i].id == id)
+		{
+			// keep the insertion order
+			memmove(entries + i, entries + i + 1, (count - i - 1)*sizeof(Entry));
+			count--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void AttributeList::clear()
+{
+	if(entries != inlineEntries)
+		delete[] entries;
+	entries = inlineEntries;
+	count = 0;
+	capacity = ATTRIBUTELIST_INLINE_SIZE;
+}
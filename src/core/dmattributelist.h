@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#ifndef DMATTRIBUTELIST_H
+#define DMATTRIBUTELIST_H
+
+#include <dmcompilersettings.h>
+#include <string>
+#include <cstddef>
+
+namespace DM {
+
+class Attribute;
+
+typedef unsigned int AttributeId;
+
+/**************************************************************//**
+@class DM::AttributeNames
+@ingroup DynaMind-Core
+@brief Process wide table of interned attribute names
+
+COMMENTS
+Every attribute name gets a small integer id on its first use. The id
+is the same in all systems and views and stays valid until the process
+ends, names are never removed. Components store and compare ids
+instead of strings. Module authors may look up the ids of frequently
+used names once and access attributes via Component::getAttribute(AttributeId).
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT AttributeNames
+{
+public:
+	//!< returns the id of the name, unknown names are added to the table
+	static AttributeId GetId(const std::string& name);
+	//!< returns false if the name has never been used, the table is not changed
+	static bool FindId(const std::string& name, AttributeId* id);
+	//!< returns the name of a valid id
+	static const std::string& GetName(AttributeId id);
+	//!< number of interned names
+	static unsigned int Count();
+};
+
+// number of attributes stored inside of an AttributeList without a heap allocation
+#define ATTRIBUTELIST_INLINE_SIZE 4
+
+/**************************************************************//**
+@class DM::AttributeList
+@ingroup DynaMind-Core
+@brief Flat container of the attributes of a component
+
+COMMENTS
+Entries are kept in insertion order in an array, searching compares
+attribute ids only. The first ATTRIBUTELIST_INLINE_SIZE entries are
+stored inline, bigger lists move to the heap.
+A NULL attribute is a valid entry, see Component::MoveAttributeToDb.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT AttributeList
+{
+public:
+	struct Entry
+	{
+		AttributeId	id;
+		Attribute*	attribute;
+	};
+
+	AttributeList();
+	AttributeList(const AttributeList& other);
+	AttributeList& operator=(const AttributeList& other);
+	~AttributeList();
+
+	unsigned int size() const {return count;}
+	Entry& at(unsigned int i) {return entries[i];}
+	const Entry& at(unsigned int i) const {return entries[i];}
+
+	//!< returns the slot of the attribute, NULL if there is no entry
+	inline Attribute** find(AttributeId id)
+	{
+		for(Entry* e = entries, *end = entries + count; e != end; ++e)
+			if(e->id == id)
+				return &e->attribute;
+		return NULL;
+	}
+	inline bool contains(AttributeId id) const
+	{
+		return const_cast<AttributeList*>(this)->find(id) != NULL;
+	}
+	//!< returns the slot of the attribute, a NULL entry is added if there is none
+	Attribute*& operator[](AttributeId id);
+	//!< removes the entry, returns false if there is none
+	bool remove(AttributeId id);
+	void clear();
+private:
+	void reserve(unsigned int size);
+
+	Entry*			entries;	// inlineEntries or heap
+	unsigned int	count;
+	unsigned int	capacity;
+	Entry			inlineEntries[ATTRIBUTELIST_INLINE_SIZE];
+};
+
+}	// namespace DM
+
+#endif // DMATTRIBUTELIST_H
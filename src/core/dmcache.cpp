@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <dmcache.h>
+#include <dmlogger.h>
+#include <QAtomicInt>
+
+using namespace DM;
+
+#define CACHE_POLICY_COUNT 2
+
+static const char* policyNames[CACHE_POLICY_COUNT] = {"lru", "2q"};
+static unsigned long policyHits[CACHE_POLICY_COUNT] = {0, 0};
+static unsigned long policyMisses[CACHE_POLICY_COUNT] = {0, 0};
+static QMutex statisticsMutex;
+
+static QAtomicInt budgetUsedKB(0);
+static QAtomicInt budgetLimitKB(0);
+static QAtomicInt budgetShards(0);
+
+void CacheStatistics::Add(CachePolicy policy, unsigned long hits, unsigned long misses)
+{
+	QMutexLocker ml(&statisticsMutex);
+	policyHits[policy] += hits;
+	policyMisses[policy] += misses;
+}
+
+unsigned long CacheStatistics::GetHits(CachePolicy policy)
+{
+	QMutexLocker ml(&statisticsMutex);
+	return policyHits[policy];
+}
+
+unsigned long CacheStatistics::GetMisses(CachePolicy policy)
+{
+	QMutexLocker ml(&statisticsMutex);
+	return policyMisses[policy];
+}
+
+void CacheStatistics::Reset()
+{
+	QMutexLocker ml(&statisticsMutex);
+	for(int i=0;i<CACHE_POLICY_COUNT;i++)
+	{
+		policyHits[i] = 0;
+		policyMisses[i] = 0;
+	}
+}
+
+void CacheStatistics::Print()
+{
+	QMutexLocker ml(&statisticsMutex);
+	for(int i=0;i<CACHE_POLICY_COUNT;i++)
+	{
+		unsigned long total = policyHits[i] + policyMisses[i];
+		Logger(Standard) << "cache statistics " << policyNames[i] << ":\t"
+			<< "misses: " << (long)policyMisses[i]
+			<< "\thits: " << (long)policyHits[i]
+			<< "\thit rate: " << (total ? (double)policyHits[i]/total : 0.0);
+	}
+}
+
+void CacheBudget::SetLimit(qint64 bytes)
+{
+	// a limit below one kilobyte must not become unlimited
+	budgetLimitKB = (int)((bytes + 1023) >> 10);
+}
+
+qint64 CacheBudget::GetLimit()
+{
+	return (qint64)(int)budgetLimitKB << 10;
+}
+
+qint64 CacheBudget::GetUsedBytes()
+{
+	return (qint64)(int)budgetUsedKB << 10;
+}
+
+bool CacheBudget::IsExceeded()
+{
+	int limit = budgetLimitKB;
+	return limit > 0 && (int)budgetUsedKB > limit;
+}
+
+void CacheBudget::Add(int kilobytes)
+{
+	budgetUsedKB.fetchAndAddOrdered(kilobytes);
+}
+
+void CacheBudget::AddShards(int count)
+{
+	budgetShards.fetchAndAddOrdered(count);
+}
+
+qint64 CacheBudget::GetShareBytes()
+{
+	int shards = budgetShards;
+	return GetLimit() / std::max(shards, 1);
+}
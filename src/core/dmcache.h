@@ -26,8 +26,11 @@
 #ifndef DMCACHE_H
 #define DMCACHE_H
 
-#include <dmdbconnector.h>
+#include <dmcompilersettings.h>
 #include <QMutex>
+#include <QHash>
+#include <QByteArray>
+#include <algorithm>
 
 namespace DM {
 
@@ -37,6 +40,90 @@ namespace DM {
 // records cache hits and misses, it may decrease performance
 #define CACHE_PROFILING 
 
+// maximum number of independently locked shards of a cache, has to be a power of two
+#define CACHE_SHARDS 16
+
+// minimum capacity of a shard; smaller caches use less shards, down to a single one
+#define CACHE_MIN_SHARD_SIZE 256
+
+enum CachePolicy
+{
+	CACHE_LRU,	//!< drops the least recently used element
+	CACHE_2Q	//!< scan resistant: elements seen once are dropped first, keys coming back soon are kept longer
+};
+
+/**************************************************************//**
+@class DM::CacheStatistics
+@ingroup DynaMind-Core
+@brief Collects the hits and misses of all caches per eviction policy.
+
+COMMENTS
+Caches report their counters when they are destroyed or when
+ReportProfilingCounters is called, only with CACHE_PROFILING.
+******************************************************************/
+class DM_HELPER_DLL_EXPORT CacheStatistics
+{
+public:
+	//!< adds the counters of a cache with the given policy
+	static void Add(CachePolicy policy, unsigned long hits, unsigned long misses);
+	static unsigned long GetHits(CachePolicy policy);
+	static unsigned long GetMisses(CachePolicy policy);
+	static void Reset();
+	//!< logs hits, misses and hit rate of each policy
+	static void Print();
+};
+
+/**************************************************************//**
+@class DM::CacheBudget
+@ingroup DynaMind-Core
+@brief Global memory budget in bytes shared by all caches.
+
+COMMENTS
+Each cache accounts the size of its entries, see cacheEntrySize. As
+long as the budget is exceeded, a shard adding an element drops
+elements according to its policy down to its fair share, the limit
+divided by the shard count of all caches. So a small cache is not
+emptied by a large one, the shards above their share shrink on their
+next insert until the budget fits again. Each shard keeps at least
+one element. The limit is set via
+DBConnectorConfig::cacheMemoryBudget, 0 disables it. Bytes are
+accounted in kilobytes, each shard may be off by less than one.
+Within the core only the raster block caches use it, attribute values
+are not cached.
+******************************************************************/
+class DM_HELPER_DLL_EXPORT CacheBudget
+{
+public:
+	//!< sets the limit in bytes, rounded up to kilobytes, 0 is unlimited. Caches shrink on their next insert
+	static void SetLimit(qint64 bytes);
+	static qint64 GetLimit();
+	//!< returns the bytes accounted by all caches
+	static qint64 GetUsedBytes();
+	//!< returns true if a limit is set and the caches use more
+	static bool IsExceeded();
+	//!< accounts the given change in kilobytes, called by the caches
+	static void Add(int kilobytes);
+	//!< registers or unregisters shards, called by the caches
+	static void AddShards(int count);
+	//!< returns the part of the limit in bytes a single shard may use
+	static qint64 GetShareBytes();
+};
+
+//!< memory used by a cached value; measured when it is added or replaced.
+// Each value type of a cache needs an overload, values owning heap memory have to count it
+inline qint64 cacheEntrySize(const float*)
+{
+	return sizeof(float);
+}
+inline qint64 cacheEntrySize(const double*)
+{
+	return sizeof(double);
+}
+inline qint64 cacheEntrySize(const QByteArray* v)
+{
+	return sizeof(QByteArray) + v->capacity();
+}
+
 /**************************************************************//**
 @class DM::Cache
 @ingroup DynaMind-Core
@@ -44,16 +131,36 @@ namespace DM {
 Offers get, add, replace, remove for a key value pair.
 
 COMMENTS
-Implemented as highly performant double-ended list without iterator,
-NULL pointer checks or similar safty structures. Searching is
-accelerated by a std::map with pointers to the desired element.
-Each method is optimized to maximum performance in several test
-cases (e.g. unit tests). Modify with care.
+The cache is split into up to CACHE_SHARDS shards, selected by the
+hash of the key. Each shard has its own mutex, a QHash index and
+double-ended lists sorted by access order, so threads working on
+different keys rarely wait for each other. The capacity is split
+evenly over the shards and each shard evicts its own elements, which
+makes the eviction order approximate across shards. Caches smaller
+than 2*CACHE_MIN_SHARD_SIZE have a single shard.
+The shard count is fixed at construction, resize only changes the
+capacity of the shards.
+Besides the element count, the size is limited by the global
+CacheBudget.
+
+EVICTION POLICIES
+CACHE_LRU drops the least recently used element.
+CACHE_2Q (full 2Q) puts new elements into a fifo of a quarter of the
+capacity. Elements dropped from the fifo leave their key in a ghost
+list of half the capacity. A key added again while it is a ghost goes
+to the lru list, which is only dropped from if the fifo is within its
+share. A single pass over many elements therefore only cycles the
+fifo and keeps the frequently used elements.
+
+The lists are implemented without iterator, NULL pointer checks or
+similar safty structures. Modify with care.
+The key type has to provide qHash(Tkey).
 ******************************************************************/
 template<class Tkey,class Tvalue>
 class Cache
 {
 protected:
+	class List;
 	// double ended node structure
 	class Node
 	{
@@ -62,12 +169,16 @@ protected:
 		Tvalue* value;
 		Node* next;
 		Node* last;
+		List* list;
+		qint64 bytes;	// accounted size of node and value
 		Node(const Tkey &k, Tvalue* v)
 		{
 			key=k;
 			value=v;
 			next = NULL;
 			last = NULL;
+			list = NULL;
+			bytes = 0;
 		}
 		~Node()
 		{
@@ -75,186 +186,425 @@ protected:
 				delete value;
 		}
 	};
-protected:
-	// map for fast searching
-	std::map<Tkey,Node*> map;
+	// double ended list of nodes
+	class List
+	{
+	public:
+		Node*	_root;
+		Node*	_last;
+		unsigned long	_cnt;
+		List()
+		{
+			_root = NULL;
+			_last = NULL;
+			_cnt = 0;
+		}
+		// pushes the given node to the front
+		void push_front(Node* n)
+		{
+			if(_last==NULL)
+				_last = n;
+
+			n->next = _root;
+			n->last = NULL;
+			n->list = this;
+			if(_root != NULL)
+				_root->last = n;
+			_root = n;
+			_cnt++;
+		}
+		// releases the given list node
+		Node* pop(Node* n)
+		{
+			Node* last = n->last;
+			Node* next = n->next;
+			if(last)
+				last->next = next;
+			if(next)
+				next->last = last;
+			if(n==_last)
+				_last = last;
+			if(n==_root)
+				_root = next;
+			_cnt--;
+			return n;
+		}
+		// deletes all nodes
+		void clear()
+		{
+			Node* cur;
+			Node* next = _root;
+			while(next!=NULL)
+			{
+				cur=next;
+				next=cur->next;
+				delete cur;
+			}
+			_root = NULL;
+			_last = NULL;
+			_cnt = 0;
+		}
+	};
+	// independently locked part of the cache
+	class Shard
+	{
+	public:
+		// hash index for fast searching
+		QHash<Tkey,Node*> map;
+		List	lru;	// recently used elements, with CACHE_2Q the ones seen repeatedly
+		List	fifo;	// CACHE_2Q: elements seen once
+		List	ghosts;	// CACHE_2Q: keys recently dropped from fifo, without values
+		QHash<Tkey,Node*> ghostMap;
+		CachePolicy	policy;
+		unsigned long	capacity;	// 0 is infinite
+		qint64	bytes;			// accounted size of all elements
+		int		reportedKB;		// part of bytes reported to CacheBudget
+		QMutex	mutex;
+#ifdef CACHE_PROFILING
+		unsigned long hits;
+		unsigned long misses;
+#endif
+		Shard(CachePolicy p): mutex(QMutex::Recursive)
+		{
+			policy = p;
+			capacity = 0;
+			bytes = 0;
+			reportedKB = 0;
+#ifdef CACHE_PROFILING
+			hits = 0;
+			misses = 0;
+#endif
+		}
+		// returns the current element count
+		inline unsigned long count() const
+		{
+			return lru._cnt + fifo._cnt;
+		}
+		// changes the accounted size, reports full kilobytes to the budget
+		inline void account(qint64 delta)
+		{
+			bytes += delta;
+			int kb = (int)(bytes >> 10);
+			if(kb != reportedKB)
+			{
+				CacheBudget::Add(kb - reportedKB);
+				reportedKB = kb;
+			}
+		}
+		// sets the value of a node and accounts its size
+		inline void setValue(Node* n, Tvalue* v)
+		{
+			if(n->value != v)
+				delete n->value;
+			n->value = v;
+			qint64 size = sizeof(Node) + (v ? cacheEntrySize(v) : 0);
+			account(size - n->bytes);
+			n->bytes = size;
+		}
+		// search for the node with the given key
+		inline Node* search(const Tkey &key) const
+		{
+			typename QHash<Tkey,Node*>::const_iterator it = map.constFind(key);
+			if(it==map.constEnd())
+				return NULL;
+			return it.value();
+		}
+		// adds a new node according to the policy, the key must not exist
+		Node* insert(const Tkey &k, Tvalue* v)
+		{
+			Node* n = new Node(k,NULL);
+			setValue(n, v);
+			map.insert(k, n);
+
+			List* target = &lru;
+			if(policy == CACHE_2Q)
+			{
+				Node* g = ghostMap.take(k);
+				if(g)
+					delete ghosts.pop(g);
+				else
+					target = &fifo;
+			}
+			target->push_front(n);
+			return n;
+		}
+		// marks the node as used
+		inline void touch(Node* n)
+		{
+			// fifo elements keep their position
+			if(n->list == &lru && n != lru._root)
+			{
+				lru.pop(n);
+				lru.push_front(n);
+			}
+		}
+		// returns the element to drop next
+		inline Node* victim() const
+		{
+			if(fifo._cnt && (fifo._cnt > std::max(capacity/4, 1UL) || !lru._cnt))
+				return fifo._last;
+			return lru._last;
+		}
+		// removes a node; does not account for linking
+		inline void removeNode(Node* n)
+		{
+			map.remove(n->key);
+			account(-n->bytes);
+			delete n->list->pop(n);
+		}
+		// drops the node due to the size limit
+		void drop(Node* n)
+		{
+			if(n->list != &fifo)
+			{
+				removeNode(n);
+				return;
+			}
+			// keep the key as ghost
+			map.remove(n->key);
+			fifo.pop(n);
+			setValue(n, NULL);
+			account(-n->bytes);
+			n->bytes = 0;
+			ghosts.push_front(n);
+			ghostMap.insert(n->key, n);
+			while(ghosts._cnt > std::max(capacity/2, 1UL))
+			{
+				ghostMap.remove(ghosts._last->key);
+				delete ghosts.pop(ghosts._last);
+			}
+		}
+		// deletes all nodes and ghosts
+		void clear()
+		{
+			lru.clear();
+			fifo.clear();
+			ghosts.clear();
+			map.clear();
+			ghostMap.clear();
+			account(-bytes);
+		}
+	};
 
-	Node*   _root;
-	Node*   _last;
-	unsigned long    _size;
-	unsigned long    _cnt;
-	QMutex*	mutex;
+	Shard**	shards;
+	unsigned int	shardCount;
+	unsigned long	_size;		// capacity of the whole cache
+	unsigned long	_shardSize;	// capacity of a single shard
+	CachePolicy	policy;
 
-	// sets up a new node; be aware that no linking is done
-	inline Node* newNode(const Tkey &k, Tvalue* v)
+	// returns the shard responsible for the given key
+	inline Shard* shardOf(const Tkey &key) const
 	{
-		Node* n = new Node(k,v);
-		map[k] = n;
-		return n;
+		// mix the bits, qHash of pointers and small ints is poorly distributed in the low bits
+		uint h = qHash(key);
+		h ^= h >> 16;
+		h *= 0x45d9f3b;
+		h ^= h >> 16;
+		return shards[h & (shardCount-1)];
 	}
-	// removes a node; does not accoutn for linking
-	inline void removeNode(Node* n)
+	// called for each element dropped due to the size limit, right before it is deleted
+	virtual void evict(Node* n){}
+	// drops the given number of elements of the shard according to the policy, needs the shard lock
+	void shrink(Shard* s, unsigned long count)
 	{
-		map.erase(n->key);
-		delete pop(n);
+		for(unsigned long i=0;i<count && s->count();i++)
+		{
+			Node* n = s->victim();
+			evict(n);
+			s->drop(n);
+		}
 	}
-	// pushes the given node to the front
-	void push_front(Node* n)
+	// returns true if the budget is exceeded and the shard uses more than its share
+	inline bool overBudget(Shard* s)
 	{
-		if(_last==NULL)
-			_last = n;
-
-		n->next = _root;
-		n->last = NULL;
-		if(_root != NULL)
-			_root->last = n;
-		_root = n;
-		_cnt++;
+		return s->count() > 1 && CacheBudget::IsExceeded() && s->bytes > CacheBudget::GetShareBytes();
 	}
-	// releases the first list node
-	Node* pop(Node* n)
+	// drops elements until the shard fits its capacity and the budget, needs the shard lock
+	inline void fit(Shard* s)
 	{
-		Node* last = n->last;
-		Node* next = n->next;
-		if(last)
-			last->next = next;
-		if(next)
-			next->last = last;
-		if(n==_last)
-			_last = last;
-		if(n==_root)
-			_root = next;
-		_cnt--;
-		return n;
+		if(_shardSize && s->count() > _shardSize)
+			shrink(s, s->count() - _shardSize);
+		while(overBudget(s))
+			shrink(s, 1);
 	}
-	// search for the node with the given key
-	Node* search(const Tkey &key)
+	// sets the capacity without evicting
+	void setCapacity(unsigned long size)
 	{
-		typename std::map<Tkey,Node*>::iterator it = map.find(key);
-		if(it==map.end())
-			return NULL;
-		return it->second;
+		_size = size;
+		_shardSize = size ? (size + shardCount - 1)/shardCount : 0;
+		for(unsigned int i=0;i<shardCount;i++)
+			shards[i]->capacity = _shardSize;
 	}
 
 public:
 #ifdef CACHE_PROFILING
-	// counters for profiling
-	unsigned long hits;
-	unsigned long misses;
+	//!< returns the number of hits since the last reset
+	unsigned long getHits()
+	{
+		unsigned long hits = 0;
+		for(unsigned int i=0;i<shardCount;i++)
+		{
+			shards[i]->mutex.lockInline();
+			hits += shards[i]->hits;
+			shards[i]->mutex.unlockInline();
+		}
+		return hits;
+	}
+	//!< returns the number of misses since the last reset
+	unsigned long getMisses()
+	{
+		unsigned long misses = 0;
+		for(unsigned int i=0;i<shardCount;i++)
+		{
+			shards[i]->mutex.lockInline();
+			misses += shards[i]->misses;
+			shards[i]->mutex.unlockInline();
+		}
+		return misses;
+	}
 	void ResetProfilingCounters()
 	{
-		mutex->lockInline();
-		misses = 0;
-		hits = 0;
-		mutex->unlockInline();
+		for(unsigned int i=0;i<shardCount;i++)
+		{
+			shards[i]->mutex.lockInline();
+			shards[i]->misses = 0;
+			shards[i]->hits = 0;
+			shards[i]->mutex.unlockInline();
+		}
+	}
+	//!< adds the counters to CacheStatistics and resets them
+	void ReportProfilingCounters()
+	{
+		for(unsigned int i=0;i<shardCount;i++)
+		{
+			shards[i]->mutex.lockInline();
+			CacheStatistics::Add(policy, shards[i]->hits, shards[i]->misses);
+			shards[i]->misses = 0;
+			shards[i]->hits = 0;
+			shards[i]->mutex.unlockInline();
+		}
 	}
 #endif
 	//!< initializes a new cache structure with the given maximum size; a size of 0 results in an infinite cache
-	Cache(unsigned long size)
+	Cache(unsigned long size, CachePolicy policy = CACHE_LRU)
 	{
-		_size=size;
-		_cnt = 0;
-		_root = NULL;
-		_last = NULL;
-		mutex = new QMutex(QMutex::Recursive);
-#ifdef CACHE_PROFILING
-		hits = 0;
-		misses = 0;
-#endif
+		this->policy = policy;
+		shardCount = CACHE_SHARDS;
+		if(size)
+			while(shardCount > 1 && size/shardCount < CACHE_MIN_SHARD_SIZE)
+				shardCount /= 2;
+
+		shards = new Shard*[shardCount];
+		for(unsigned int i=0;i<shardCount;i++)
+			shards[i] = new Shard(policy);
+		CacheBudget::AddShards(shardCount);
+
+		setCapacity(size);
 	}
 	//!< deletes all nodes, leaves the values untouched (non-deep delete)
-	~Cache()
+	virtual ~Cache()
 	{
+#ifdef CACHE_PROFILING
+		ReportProfilingCounters();
+#endif
 		Clear();
-		delete mutex;
+		for(unsigned int i=0;i<shardCount;i++)
+			delete shards[i];
+		delete[] shards;
+		CacheBudget::AddShards(-(int)shardCount);
 	}
 	//!< deletes all nodes, leaves the values untouched (non-deep delete)
 	virtual void Clear()
 	{
-		mutex->lockInline();
-		Node* cur;
-		Node* next;
-		next = _root;
-		while(next!=NULL)
+		for(unsigned int i=0;i<shardCount;i++)
 		{
-			cur=next;
-			next=cur->next;
-			delete cur;
+			shards[i]->mutex.lockInline();
+			shards[i]->clear();
+			shards[i]->mutex.unlockInline();
 		}
-		map.clear();
-		_root = NULL;
-		_last = NULL;
-		_cnt = 0;
-		mutex->unlockInline();
 	}
-	//!< returns the current element count
+	//!< returns the maximum element count
 	unsigned long getSize(){return _size;};
+	//!< returns the number of shards
+	unsigned int getShardCount(){return shardCount;}
+	//!< returns the eviction policy
+	CachePolicy getPolicy(){return policy;}
 	//!< returns the value associated with the given key 
 	virtual Tvalue* get(const Tkey& key)
 	{
-		mutex->lockInline();
-		Node *n = search(key);
-		// push front
+		Shard* s = shardOf(key);
+		s->mutex.lockInline();
+		Node *n = s->search(key);
 		if(n!=NULL)
 		{
-			pop(n);
-			push_front(n);
+			s->touch(n);
 #ifdef CACHE_PROFILING
-			hits++;
+			s->hits++;
 #endif
-
-			mutex->unlockInline();
+			s->mutex.unlockInline();
 			return n->value;
 		}
 #ifdef CACHE_PROFILING
-		misses++;
+		s->misses++;
 #endif
-		mutex->unlockInline();
+		s->mutex.unlockInline();
 		return NULL;
 	}
 	//!< adds a new key-value pair, does nothing if key exists. 
-	// If the maximum size is reached, it will remove the last key
+	// If the maximum size of the shard is reached, it will remove an element according to the policy
 	virtual void add(const Tkey& key,Tvalue* value)
 	{
-		mutex->lockInline();
-		if(search(key) != NULL)
+		Shard* s = shardOf(key);
+		s->mutex.lockInline();
+		if(s->search(key) != NULL)
 		{
-			mutex->unlockInline();
+			s->mutex.unlockInline();
 			return;
 		}
 
-		Node *n = newNode(key,value);
-		push_front(n);
+		s->insert(key,value);
+		fit(s);
 
-		if(_size)
-			if(_cnt>_size)
-				removeNode(_last);
-
-		mutex->unlockInline();
+		s->mutex.unlockInline();
 	}
 	//!< replaces the value associated with the given key, returns false if key was not existant
 	virtual bool replace(const Tkey& key,Tvalue* value)
 	{
-		mutex->lockInline();
-		Node *n = search(key);
+		Shard* s = shardOf(key);
+		s->mutex.lockInline();
+		Node *n = s->search(key);
 		if(n==NULL)
 		{
-			mutex->unlockInline();
+			s->mutex.unlockInline();
 			return false;
 		}
 
-		removeNode(n);
-		add(key, value);
-		mutex->unlockInline();
+		s->setValue(n, value);
+		s->touch(n);
+		s->mutex.unlockInline();
 		return true;
 	}
 	//!< removes the element from cache
 	void remove(const Tkey& key)
 	{
-		mutex->lockInline();
-		Node *n = search(key);
-		if(n)	removeNode(n);
-		mutex->unlockInline();
+		Shard* s = shardOf(key);
+		s->mutex.lockInline();
+		Node *n = s->search(key);
+		if(n)	s->removeNode(n);
+		s->mutex.unlockInline();
+	}
+	//!< resizes the cache, if the given value is 0, the cache is set to infinite
+	virtual void resize(unsigned long size)
+	{
+		for(unsigned int i=0;i<shardCount;i++)
+			shards[i]->mutex.lockInline();
+
+		setCapacity(size);
+		for(unsigned int i=0;i<shardCount;i++)
+		{
+			fit(shards[i]);
+			shards[i]->mutex.unlockInline();
+		}
 	}
 };
 }   // namespace DM
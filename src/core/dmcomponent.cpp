@@ -56,12 +56,31 @@ public:
 static QMutex componentSyncMutex;
 static ComponentSyncMap componentSyncMap;
 
+class RecursiveMutex: public QMutex
+{
+public:
+	RecursiveMutex(): QMutex(QMutex::Recursive){}
+};
+
+// never freed, components may still be destroyed during static destruction
+static RecursiveMutex* componentMutexes = NULL;
+
+static QMutex* GetComponentMutex(const QUuid& uuid)
+{
+	if(!componentMutexes)
+		componentMutexes = new RecursiveMutex[COMPONENT_MUTEX_STRIPES];
+	return &componentMutexes[qHash(uuid) % COMPONENT_MUTEX_STRIPES];
+}
+
+// create the pool during static initialization, before any thread is started
+static QMutex* componentMutexesInit = GetComponentMutex(QUuid());
+
 Component::Component()
 {
-	mutex = new QMutex(QMutex::Recursive);
 	DBConnector::getInstance();
 	uuid = QUuid::createUuid();
-	ownedattributes = std::map<std::string,Attribute*>();
+	mutex = GetComponentMutex(uuid);
+	ownsMutex = false;
 
 //	inViews = std::set<std::string>();
 	currentSys = NULL;
@@ -73,28 +92,30 @@ Component::Component()
 
 Component::Component(bool b)
 {
-	mutex = new QMutex(QMutex::Recursive);
 	DBConnector::getInstance();
 	uuid = QUuid::createUuid();
-	ownedattributes = std::map<std::string,Attribute*>();
+	mutex = GetComponentMutex(uuid);
+	ownsMutex = false;
 
 //	inViews = std::set<std::string>();
 	currentSys = NULL;
 	isCached = false;
 }
 
+// keeps the uuid, successor copies are constructed with a new one
 void Component::CopyFrom(const Component &c, bool successor)
 {
-	uuid = QUuid::createUuid();
+	// successor copies are found by the name of their source, which is created on demand
+	nameUuid = successor ? const_cast<Component&>(c).getNameUUID() : c.nameUuid;
 //	inViews = c.inViews;
 	//currentSys = NULL;
 
 	if(!successor)
 	{
-		mforeach(Attribute* a, c.ownedattributes)
+		for(unsigned int i=0;i<c.ownedattributes.size();i++)
 		{
-			Attribute* newa = new Attribute(*a);
-			ownedattributes[newa->getName()] = newa;
+			Attribute* newa = new Attribute(*c.ownedattributes.at(i).attribute);
+			ownedattributes[newa->getNameId()] = newa;
 			newa->setOwner(this);
 		}
 	}
@@ -105,8 +126,13 @@ void Component::CopyFrom(const Component &c, bool successor)
 Component::Component(const Component& c)
 {
 	currentSys = NULL;
-	mutex = new QMutex(QMutex::Recursive);
+	uuid = QUuid::createUuid();
 	CopyFrom(c);
+	mutex = GetComponentMutex(uuid);
+	ownsMutex = false;
+	// copies of systems and rasters lock others as well
+	if(c.ownsMutex)
+		UseOwnMutex();
 	componentSyncMap.insert(this);
 	isCached = true;
 }
@@ -114,17 +140,21 @@ Component::Component(const Component& c)
 Component::Component(const Component& c, bool bInherited)
 {
 	currentSys = NULL;
-	mutex = new QMutex(QMutex::Recursive);
+	uuid = QUuid::createUuid();
 	CopyFrom(c);
+	mutex = GetComponentMutex(uuid);
+	ownsMutex = false;
+	if(c.ownsMutex)
+		UseOwnMutex();
 	isCached = false;
 }
 
 Component::~Component()
 {
 	mutex->lockInline();
-	mforeach(Attribute* a, ownedattributes)
-		if(a->GetOwner() == this)
-			delete a;
+	for(unsigned int i=0;i<ownedattributes.size();i++)
+		if(ownedattributes.at(i).attribute->GetOwner() == this)
+			delete ownedattributes.at(i).attribute;
 
 	ownedattributes.clear();
 	if(isCached)
@@ -132,7 +162,16 @@ Component::~Component()
 	// if this class is not of type component, nothing will happen
 	SQLDelete();
 	mutex->unlockInline();
-	delete mutex;
+	if(ownsMutex)
+		delete mutex;
+}
+
+void Component::UseOwnMutex()
+{
+	if(ownsMutex)
+		return;
+	mutex = new QMutex(QMutex::Recursive);
+	ownsMutex = true;
 }
 
 Component& Component::operator=(const Component& other)
@@ -141,8 +180,11 @@ Component& Component::operator=(const Component& other)
 
 	if(this != &other)
 	{
-		mforeach(Attribute* a, other.ownedattributes)
-			this->addAttribute(*a);
+		for(unsigned int i=0;i<other.ownedattributes.size();i++)
+			this->addAttribute(*other.ownedattributes.at(i).attribute);
+		// like the attributes, an existing name is not overwritten
+		if(nameUuid.isNull())
+			nameUuid = other.nameUuid;
 	}
 	return *this;
 }
@@ -158,18 +200,49 @@ bool Component::isInView(View view) const
 
 std::string Component::getUUID()
 {
+	QUuid id = getNameUUID();
+
 	Attribute* a = this->getAttribute(UUID_ATTRIBUTE_NAME);
-	std::string name = a->getString();
-	if(name == "")	
+	std::string strName = a->getString();
+	if(strName == "")	
 	{
 		QMutexLocker ml(mutex);
+		// another thread may have written the name in the meantime
+		strName = a->getString();
+		if(strName == "")
+		{
+			strName = id.toString().toStdString();
+			a->setString(strName);
+		}
+	}
+	return strName;
+}
+QUuid Component::getNameUUID()
+{
+	if(nameUuid.isNull())
+	{
+		mutex->lockInline();
+		// another thread may have created the name in the meantime
+		bool created = nameUuid.isNull();
+		if(created)
+		{
+			// take over a name written via the attribute, e.g. copied by operator=
+			if(HasAttribute(UUID_ATTRIBUTE_NAME))
+				nameUuid = QUuid(QString::fromStdString(getAttribute(UUID_ATTRIBUTE_NAME)->getString()));
+			if(nameUuid.isNull())
+				nameUuid = QUuid::createUuid();
+		}
+		mutex->unlockInline();
 
-		name = QUuid::createUuid().toString().toStdString();
-		a->setString(name);
-		if(this->currentSys && currentSys != this)	// avoid self referencing
-			currentSys->componentNameMap[name] = this;
+		// the system map is shared by all threads working on the system,
+		// do not hold our own lock while waiting for the system lock
+		if(created && this->currentSys && currentSys != this)	// avoid self referencing
+		{
+			QMutexLocker ml(currentSys->mutex);
+			currentSys->componentNameMap[nameUuid] = this;
+		}
 	}
-	return name;
+	return nameUuid;
 }
 QUuid Component::getQUUID() const
 {
@@ -185,23 +258,23 @@ QString Component::getTableName()
 	return "components";
 }
 
-bool Component::addAttribute(std::string name, double val) 
+bool Component::addAttribute(const std::string& name, double val) 
 {
 	QMutexLocker ml(mutex);
 
 	//if(HasAttribute(name))
-	if(map_contains(&ownedattributes, name))
+	if(HasAttribute(name))
 		return this->changeAttribute(name, val);
 
 	return this->addAttribute(new Attribute(name, val));
 }
 
-bool Component::addAttribute(std::string name, std::string val) 
+bool Component::addAttribute(const std::string& name, const std::string& val) 
 {
 	QMutexLocker ml(mutex);
 
 	//if(HasAttribute(name))
-	if(map_contains(&ownedattributes, name))
+	if(HasAttribute(name))
 		return this->changeAttribute(name, val);
 
 	return this->addAttribute(new Attribute(name, val));
@@ -212,11 +285,11 @@ bool Component::addAttribute(const Attribute &newattribute)
 	QMutexLocker ml(mutex);
 
 	//if(HasAttribute(newattribute.getName()))
-	if(map_contains(&ownedattributes, newattribute.getName()))
+	if(ownedattributes.contains(newattribute.getNameId()))
 		return this->changeAttribute(newattribute);
 
 	Attribute * a = new Attribute(newattribute);
-	ownedattributes[newattribute.getName()] = a;
+	ownedattributes[newattribute.getNameId()] = a;
 
 	a->setOwner(this);
 	return true;
@@ -227,10 +300,11 @@ bool Component::addAttribute(Attribute *pAttribute)
 	QMutexLocker ml(mutex);
 
 	//if(HasAttribute(pAttribute->getName()))
-	if(map_contains(&ownedattributes, pAttribute->getName()))
-		delete ownedattributes[pAttribute->getName()];
+	Attribute*& slot = ownedattributes[pAttribute->getNameId()];
+	if(slot)
+		delete slot;
 
-	ownedattributes[pAttribute->getName()] = pAttribute;
+	slot = pAttribute;
 	pAttribute->setOwner(this);
 	return true;
 }
@@ -239,83 +313,105 @@ bool Component::changeAttribute(const Attribute &newattribute)
 {
 	QMutexLocker ml(mutex);
 
-	getAttribute(newattribute.getName())->Change(newattribute);
+	getAttribute(newattribute.getNameId())->Change(newattribute);
 	return true;
 }
 
-bool Component::changeAttribute(std::string s, double val)
+bool Component::changeAttribute(const std::string& name, double val)
 {
 	QMutexLocker ml(mutex);
 
-	getAttribute(s)->setDouble(val);
+	getAttribute(name)->setDouble(val);
 	return true;
 }
 
-bool Component::changeAttribute(std::string s, std::string val)
+bool Component::changeAttribute(const std::string& name, const std::string& val)
 {
 	QMutexLocker ml(mutex);
 
-	getAttribute(s)->setString(val);
+	getAttribute(name)->setString(val);
 	return true;
 }
 
-bool Component::removeAttribute(std::string name)
+bool Component::removeAttribute(const std::string& name)
 {
 	QMutexLocker ml(mutex);
-	Attribute * a;
-	if(map_contains(&ownedattributes, name, a))
+	AttributeId id;
+	if(!AttributeNames::FindId(name, &id))
+		return false;
+
+	Attribute** slot = ownedattributes.find(id);
+	if(slot)
 	{
-		if(a->GetOwner() == this)
-			delete a;
+		if((*slot)->GetOwner() == this)
+			delete *slot;
 
-		ownedattributes.erase(name);
+		ownedattributes.remove(id);
 		return true;
 	}
 	return false;
 }
 
-Attribute* Component::getAttribute(std::string name)
+Attribute* Component::getAttribute(const std::string& name)
+{
+	return getAttribute(AttributeNames::GetId(name));
+}
+
+Attribute* Component::getAttribute(AttributeId nameId)
 {
+	// adding an attribute may move the entries of the list
+	QMutexLocker ml(mutex);
+
 	Attribute* a;
-	if(!map_contains(&ownedattributes, name, a))
+	Attribute** slot = ownedattributes.find(nameId);
+	if(!slot)
 	{
-		QMutexLocker ml(mutex);
 		// create new attribute
-		a = new Attribute(name);
+		a = new Attribute(AttributeNames::GetName(nameId));
 		a->setOwner(this);
-		ownedattributes[name] = a;
+		ownedattributes[nameId] = a;
 	}
-	else if(a == NULL)
+	else if((a = *slot) == NULL)
 	{
 		// empty attribute pointer -> load from db
-		a = ownedattributes[name] = Attribute::LoadAttribute(this, name);
+		a = ownedattributes[nameId] = Attribute::LoadAttribute(this, AttributeNames::GetName(nameId));
 	}
 	else if(a->GetOwner() != this)
 	{
 		// successor copy
-		a = ownedattributes[name] = new Attribute(*a);
+		a = ownedattributes[nameId] = new Attribute(*a);
 		a->setOwner(this);
 	}
 
 	return a;
 }
 
+const Attribute* Component::getAttributeReadOnly(AttributeId nameId) const
+{
+	Attribute** slot = const_cast<AttributeList&>(ownedattributes).find(nameId);
+	return slot ? *slot : NULL;
+}
+
 void Component::CloneAllAttributes()
 {
-	mforeach(Attribute* a, ownedattributes)
+	for(unsigned int i=0;i<ownedattributes.size();i++)
 	{
+		Attribute*& a = ownedattributes.at(i).attribute;
 		if(a->GetOwner() != this)
 		{
-			a = ownedattributes[a->getName()] = new Attribute(*a);
+			a = new Attribute(*a);
 			a->setOwner(this);
 		}
 	}
 }
 
-const std::map<std::string, Attribute*> & Component::getAllAttributes()
+std::map<std::string, Attribute*> Component::getAllAttributes()
 {
 	CloneAllAttributes();
-	return ownedattributes;
+	std::map<std::string, Attribute*> attributes;
+	for(unsigned int i=0;i<ownedattributes.size();i++)
+		attributes[AttributeNames::GetName(ownedattributes.at(i).id)] = ownedattributes.at(i).attribute;
+	return attributes;
 }
 
 
@@ -398,17 +494,45 @@ void Component::SQLDelete()
 	}
 }
 
-bool Component::HasAttribute(std::string name) const
+bool Component::HasAttribute(const std::string& name) const
 {
-	return ownedattributes.find(name)!=ownedattributes.end();
+	AttributeId id;
+	return AttributeNames::FindId(name, &id) && ownedattributes.contains(id);
 }
 
 void Component::MoveAttributeToDb(const std::string& name)
 {
-	std::map<std::string,Attribute*>::iterator it = ownedattributes.find(name);
-	if(it->second)
+	Attribute** slot = ownedattributes.find(AttributeNames::GetId(name));
+	if(slot && *slot)
+	{
+		Attribute::SaveAttribute(*slot);
+		*slot = NULL;
+	}
+}
+
+void Component::LoadAttributes(const std::vector<Component*>& components, const std::string& name)
+{
+	AttributeId id;
+	if(!AttributeNames::FindId(name, &id))
+		return;
+
+	std::vector<Component*> owners;
+	foreach(Component* c, components)
+	{
+		Attribute** slot = c->ownedattributes.find(id);
+		if(slot && *slot == NULL)
+			owners.push_back(c);
+	}
+
+	if(owners.size() == 0)
+		return;
+
+	std::vector<Attribute*> attributes;
+	Attribute::LoadAttributes(owners, name, attributes);
+
+	for(unsigned int i=0;i<owners.size();i++)
 	{
-		Attribute::SaveAttribute(it->second);
-		it->second = NULL;
+		QMutexLocker ml(owners[i]->mutex);
+		owners[i]->ownedattributes[id] = attributes[i];
 	}
 }
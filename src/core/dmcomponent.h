@@ -34,6 +34,7 @@
 #include <set>
 #include <dmview.h>
 #include <dmcompilersettings.h>
+#include <dmattributelist.h>
 #include <QMutex>
 #include <QMutexLocker>
 
@@ -45,6 +46,9 @@ namespace DM {
 
 #define UUID_ATTRIBUTE_NAME "_uuid"
 
+// number of mutexes shared by all components, see Component::mutex
+#define COMPONENT_MUTEX_STRIPES 1024
+
 class Attribute;
 class System;
 
@@ -79,9 +83,18 @@ public:
 	/** @brief return Type */
 	virtual Components getType() const;
 
-	/** @brief return UUID */
+	/** @brief return UUID
+	*
+	* The string form of getNameUUID, it is stored as attribute and meant for export.
+	* Lookups inside the core should use getNameUUID. */
 	std::string getUUID();
 
+	/** @brief returns the name of the component, created on first request.
+	*
+	* Other than getQUUID the name is shared by all successor copies and clones of the component,
+	* it identifies the component across system states, see System::getComponentByName. */
+	QUuid getNameUUID();
+
 	/** @brief return UUID */
 	QUuid getQUUID() const;
 
@@ -93,28 +106,39 @@ public:
 	bool addAttribute(const Attribute &newattribute);
 
 	/** @brief Add new double attribute to the component. If the Attribute already exists changeAttribute is called */
-	bool addAttribute(std::string, double val);
+	bool addAttribute(const std::string& name, double val);
 
 	/** @brief Add new string attribute to the component. If the Attribute already exists changeAttribute is called */
-	bool addAttribute(std::string, std::string);
+	bool addAttribute(const std::string& name, const std::string& val);
 
 	/** @brief Change existing Attribute. If attribute doesn't exist a new Attribute is added to the Component*/
 	bool changeAttribute(const Attribute &newattribute);
 
 	/** @brief Change existing double Attribute. It the Attribute doesn't exist a new double Attribute is added*/
-	bool changeAttribute(std::string, double val);
+	bool changeAttribute(const std::string& name, double val);
 
 	/** @brief Change existing double Attribute. It the Attribute doesn't exist a new double Attribute is added*/
-	bool changeAttribute(std::string s, std::string val);
+	bool changeAttribute(const std::string& name, const std::string& val);
 
 	/** @brief Remove Attribute, returns false if no Attribute with this name exists */
-	bool removeAttribute(std::string name);
+	bool removeAttribute(const std::string& name);
 
-	/** @brief Returns a pointer to an Attribute */
-	Attribute* getAttribute(std::string name);
+	/** @brief Returns a pointer to an Attribute, a new one is added if it doesn't exist */
+	Attribute* getAttribute(const std::string& name);
+
+	/** @brief Returns a pointer to an Attribute by its interned name, see AttributeNames::GetId.
+	*
+	* Saves the name lookup when accessing the same attribute of many components. */
+	Attribute* getAttribute(AttributeId nameId);
+
+	/** @brief Returns the attribute or NULL if the component doesn't have it in memory.
+	*
+	* Unlike getAttribute it doesn't create, load or copy the attribute, so it must not be changed.
+	* It doesn't lock the component, which must not be changed by other threads meanwhile */
+	const Attribute* getAttributeReadOnly(AttributeId nameId) const;
 
 	/** @brief Returns a map of all Attributes */
-	const std::map<std::string, Attribute*> & getAllAttributes();
+	std::map<std::string, Attribute*> getAllAttributes();
 
 	/** @brief adds Component to a View by using the name of the view */
 	//void setView(std::string view);
@@ -142,6 +166,9 @@ public:
 	void SaveToDb();
 
 	void MoveAttributeToDb(const std::string& name);
+
+	/** @brief loads the given attribute of all components, which have moved it to the db, with bulk selects */
+	static void LoadAttributes(const std::vector<Component*>& components, const std::string& name);
 protected:
 	/* @brief Sets stateUuid and ownership in sql db*/
 	virtual void SetOwner(Component *owner);
@@ -157,21 +184,29 @@ protected:
 
 	/** @brief return table name */
 	virtual QString getTableName();
+
+	/** @brief replaces the shared mutex by an own one, for components locking others while holding their lock */
+	void UseOwnMutex();
 	
+	/** @brief recursive lock of the component. Nodes, edges and faces share one of
+	* COMPONENT_MUTEX_STRIPES mutexes, selected by their uuid, instead of allocating an own one.
+	* A component holding a shared mutex must not lock any other component. */
 	QMutex* mutex;
 	QUuid	uuid;
+	QUuid	nameUuid;	//!< null until getNameUUID is called, see getUUID
 	System* currentSys;
 	bool	isInserted;
 	//std::set<std::string> inViews;
-	std::map<std::string,Attribute*> ownedattributes;
+	AttributeList ownedattributes;
 private:
-	bool HasAttribute(std::string name) const;
+	bool HasAttribute(const std::string& name) const;
 	void LoadAttribute(std::string name);
 	bool addAttribute(Attribute *pAttribute);
 	void CopyFrom(const Component &c, bool successor = false);
 	void CloneAllAttributes();
 
 	bool isCached;
+	bool ownsMutex;
 };
 typedef std::map<std::string, DM::Component*> ComponentMap;
 }
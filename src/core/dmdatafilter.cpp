@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#include <dmdatafilter.h>
+#include <dmcomponent.h>
+#include <dmattribute.h>
+#include <dmnode.h>
+#include <algorithm>
+
+using namespace DM;
+
+// op is a DataFilter::Operator, the switch is resolved by the compiler
+template<int op>
+inline bool Compare(double value, double ref)
+{
+	switch(op)
+	{
+	case DataFilter::GREATER:		return value > ref;
+	case DataFilter::GREATEREQUAL:	return value >= ref;
+	case DataFilter::LESS:			return value < ref;
+	case DataFilter::LESSEQUAL:		return value <= ref;
+	case DataFilter::EQUAL:			return value == ref;
+	}
+	return true;
+}
+
+template<int op, int coord>
+bool DataFilterPipeline::TestCoordinate(const CompiledFilter& f, Component* c)
+{
+	if(c->getType() != NODE)
+		return false;
+
+	const Node* n = (const Node*)c;
+	return Compare<op>(coord == DataFilter::X ? n->getX() : coord == DataFilter::Y ? n->getY() : n->getZ(), f.dvalue);
+}
+
+template<int op>
+bool DataFilterPipeline::TestDouble(const CompiledFilter& f, Component* c)
+{
+	const Attribute* a = c->getAttributeReadOnly(f.attribute);
+	// getAttribute used to create the missing attribute, which reads as 0
+	return Compare<op>(a ? a->getDouble() : 0, f.dvalue);
+}
+
+bool DataFilterPipeline::TestString(const CompiledFilter& f, Component* c)
+{
+	const Attribute* a = c->getAttributeReadOnly(f.attribute);
+	return a && a->equalsString(f.svalue);
+}
+
+bool DataFilterPipeline::TestNever(const CompiledFilter& f, Component* c)
+{
+	return false;
+}
+
+template<int op>
+void DataFilterPipeline::Select(CompiledFilter& f, const DataFilter& filter)
+{
+	switch(filter.type)
+	{
+	case DataFilter::Node:
+		if(filter.coord == DataFilter::X)		f.test = &TestCoordinate<op, DataFilter::X>;
+		else if(filter.coord == DataFilter::Y)	f.test = &TestCoordinate<op, DataFilter::Y>;
+		else if(filter.coord == DataFilter::Z)	f.test = &TestCoordinate<op, DataFilter::Z>;
+		break;
+	case DataFilter::AttributeDouble:
+		f.test = &TestDouble<op>;
+		break;
+	case DataFilter::AttributeString:
+		// strings can only be compared for equality
+		if(op == DataFilter::EQUAL)
+			f.test = &TestString;
+		break;
+	}
+}
+
+DataFilterPipeline::DataFilterPipeline(const std::vector<DataFilter*>& dataFilters)
+{
+	for(unsigned int i=0;i<dataFilters.size();i++)
+	{
+		const DataFilter& filter = *dataFilters[i];
+		CompiledFilter f;
+		f.test = &TestNever;
+		f.attribute = filter.attributeName.empty() ? 0 : AttributeNames::GetId(filter.attributeName);
+		f.dvalue = filter.dvalue;
+		f.svalue = filter.svalue;
+		f.startsAlternative = i > 0 && filter.combination == DataFilter::OR;
+		if((filter.type == DataFilter::AttributeDouble || filter.type == DataFilter::AttributeString)
+			&& std::find(attributeNames.begin(), attributeNames.end(), filter.attributeName) == attributeNames.end())
+			attributeNames.push_back(filter.attributeName);
+
+		switch(filter.op)
+		{
+		case DataFilter::GREATER:		Select<DataFilter::GREATER>(f, filter);			break;
+		case DataFilter::GREATEREQUAL:	Select<DataFilter::GREATEREQUAL>(f, filter);	break;
+		case DataFilter::LESS:			Select<DataFilter::LESS>(f, filter);			break;
+		case DataFilter::LESSEQUAL:		Select<DataFilter::LESSEQUAL>(f, filter);		break;
+		case DataFilter::EQUAL:			Select<DataFilter::EQUAL>(f, filter);			break;
+		}
+		filters.push_back(f);
+	}
+}
+
+void DataFilterPipeline::LoadAttributes(const std::vector<Component*>& components) const
+{
+	foreach(const std::string& name, attributeNames)
+		Component::LoadAttributes(components, name);
+}
+
+bool DataFilterPipeline::Passes(Component* c) const
+{
+	bool passes = true;
+	for(std::vector<CompiledFilter>::const_iterator f = filters.begin(); f != filters.end(); ++f)
+	{
+		if(f->startsAlternative)
+		{
+			if(passes)
+				return true;
+			passes = true;
+		}
+		// skip the rest of a failed alternative
+		if(passes)
+			passes = f->test(*f, c);
+	}
+	return passes;
+}
+
+void DataFilterPipeline::Apply(std::vector<Component*>& components) const
+{
+	if(filters.empty() || components.empty())
+		return;
+
+	// every chunk is compacted in place, then the chunks are moved together
+	Component** data = &components[0];
+	const long size = components.size();
+	const int chunks = (size + DATAFILTER_CHUNK_SIZE - 1) / DATAFILTER_CHUNK_SIZE;
+	std::vector<long> kept(chunks);
+
+	#pragma omp parallel for schedule(dynamic) if(chunks > 1)
+	for(int chunk = 0; chunk < chunks; chunk++)
+	{
+		Component** begin = data + (long)chunk*DATAFILTER_CHUNK_SIZE;
+		Component** end = data + std::min((long)(chunk+1)*DATAFILTER_CHUNK_SIZE, size);
+		Component** out = begin;
+		for(Component** it = begin; it != end; ++it)
+			if(Passes(*it))
+				*out++ = *it;
+		kept[chunk] = out - begin;
+	}
+
+	long count = kept[0];
+	for(int chunk = 1; chunk < chunks; chunk++)
+	{
+		Component** begin = data + (long)chunk*DATAFILTER_CHUNK_SIZE;
+		std::copy(begin, begin + kept[chunk], data + count);
+		count += kept[chunk];
+	}
+	components.resize(count);
+}
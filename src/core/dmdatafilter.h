@@ -27,9 +27,13 @@
 #define DMDATAFILTER_H
 
 #include <string>
+#include <vector>
 #include <dmcompilersettings.h>
+#include <dmattributelist.h>
 
 namespace DM {
+
+class Component;
 	
 struct DataFilter
 {
@@ -41,27 +45,35 @@ struct DataFilter
 	{
 		GREATER, GREATEREQUAL, LESS, LESSEQUAL, EQUAL, 
 	};
+	// like in sql AND binds stronger than OR: a component passes,
+	// if it passes all filters of one of the alternatives
+	enum Combination
+	{
+		AND,	// combined with the filter before
+		OR		// starts a new alternative
+	};
 
-	DataFilter(CoordinateTarget coord, Operator op, double value):
+	DataFilter(CoordinateTarget coord, Operator op, double value, Combination combination = AND):
 		attributeName(""), coord(coord), op(op), 
-		svalue(), dvalue(value), type(Node)
+		svalue(), dvalue(value), type(Node), combination(combination)
 	{}
-	DataFilter(std::string attributeName, Operator op, double value):
+	DataFilter(std::string attributeName, Operator op, double value, Combination combination = AND):
 		attributeName(attributeName), coord(None), op(op), 
-		svalue(), dvalue(value), type(AttributeDouble)
+		svalue(), dvalue(value), type(AttributeDouble), combination(combination)
 	{}
-	DataFilter(std::string attributeName, Operator op, std::string value):
+	DataFilter(std::string attributeName, Operator op, std::string value, Combination combination = AND):
 		attributeName(attributeName), coord(None), op(op), 
-		svalue(value), dvalue(0), type(AttributeString)
+		svalue(value), dvalue(0), type(AttributeString), combination(combination)
 	{}
 
-	bool operator == (const DataFilter& ref)
+	bool operator == (const DataFilter& ref) const
 	{
 		if(attributeName != ref.attributeName)	return false;
 		if(coord != ref.coord)					return false;
 		if(op != ref.op)						return false;
 		if(dvalue != ref.dvalue)				return false;
 		if(svalue != ref.svalue)				return false;
+		if(combination != ref.combination)		return false;
 
 		return true;
 	}
@@ -77,6 +89,58 @@ struct DataFilter
 	const Operator			op;
 	const double			dvalue;
 	const std::string		svalue;
+	const Combination		combination;
+};
+
+// lists with more components are filtered in parallel chunks of this size
+#define DATAFILTER_CHUNK_SIZE 65536
+
+/**************************************************************//**
+@class DM::DataFilterPipeline
+@ingroup DynaMind-Core
+@brief The filters of a view compiled for evaluation
+
+COMMENTS
+Attribute names are resolved to ids and every filter gets a test
+function specialized for its operator and target, so evaluating a
+component neither dispatches on the filter nor allocates. Attributes
+are read via Component::getAttributeReadOnly, a missing double
+attribute counts as 0. Attributes moved to the db have to be loaded
+via LoadAttributes before.
+Apply removes the rejected components in place, bigger lists are
+split into chunks filtered in parallel via OpenMP.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT DataFilterPipeline
+{
+public:
+	DataFilterPipeline() {}
+	DataFilterPipeline(const std::vector<DataFilter*>& filters);
+
+	bool empty() const {return filters.empty();}
+	//!< loads the filtered attributes of the components, which have been moved to the db, at once
+	void LoadAttributes(const std::vector<Component*>& components) const;
+	//!< returns true if the component passes the filters
+	bool Passes(Component* c) const;
+	//!< removes the components not passing the filters, keeping the order
+	void Apply(std::vector<Component*>& components) const;
+private:
+	struct CompiledFilter
+	{
+		bool	(*test)(const CompiledFilter& f, Component* c);
+		AttributeId	attribute;
+		double		dvalue;
+		std::string	svalue;
+		bool		startsAlternative;
+	};
+	template<int op> static void Select(CompiledFilter& f, const DataFilter& filter);
+	template<int op, int coord> static bool TestCoordinate(const CompiledFilter& f, Component* c);
+	template<int op> static bool TestDouble(const CompiledFilter& f, Component* c);
+	static bool TestString(const CompiledFilter& f, Component* c);
+	static bool TestNever(const CompiledFilter& f, Component* c);
+
+	std::vector<CompiledFilter>	filters;
+	std::vector<std::string>	attributeNames;
 };
 }
 
@@ -32,92 +32,50 @@
 #include "dmderivedsystem.h"
 #include <vector>
 #include <dmnode.h>
+#include <QHash>
 
 using namespace DM;
 
-bool ApplyFilter(Component* c, DataFilter* filter)
-{
-	Attribute *a = NULL;
-	Node* n = NULL;
-
-	if(filter->type == DataFilter::AttributeString || filter->type == DataFilter::AttributeDouble)
-	{
-		a = c->getAttribute(filter->attributeName);
-		if(!a)
-			return false;
-	}
-	else if (filter->type == DataFilter::Node)
-	{
-		n = dynamic_cast<Node*>(c);
-		if(!n)
-			return false;
-	}
-	
-	double dvalue;
-
-	if(filter->type == DataFilter::AttributeString)
-	{
-		if(a->getType() == Attribute::STRING && filter->op == DataFilter::EQUAL)
-			return a->getString() == filter->svalue;
-		else
-			return false;
-	}
-	else if(filter->type == DataFilter::AttributeDouble)
-		dvalue = a->getDouble();
-	else if(filter->type == DataFilter::Node)
-		dvalue = n->get(filter->coord);
-
-	if(filter->op == DataFilter::GREATER)
-		return dvalue > filter->dvalue;
-	else if(filter->op == DataFilter::GREATEREQUAL)
-		return dvalue >= filter->dvalue;
-	else if(filter->op == DataFilter::LESS)
-		return dvalue < filter->dvalue;
-	else if(filter->op == DataFilter::LESSEQUAL)
-		return dvalue <= filter->dvalue;
-	else if(filter->op == DataFilter::EQUAL)
-		return dvalue == filter->dvalue;
-
-	return true;
-}
-
-void ApplyFilters(std::vector<Component*>& componentList, std::vector<DataFilter*> filters)
+void ApplyFilters(std::vector<Component*>& componentList, const std::vector<DataFilter*>& filters)
 {
 	if(filters.size() == 0)
 		return;
 
-	std::vector<Component*> newComponentList;
-	foreach(Component* c, componentList)
-	{
-		bool excluded = false;
-		foreach(DataFilter* filter, filters)
-			if(!ApplyFilter(c, filter))
-				excluded = true;
-
-		if(!excluded)
-			newComponentList.push_back(c);
-	}
+	DataFilterPipeline pipeline(filters);
+	pipeline.LoadAttributes(componentList);
+	pipeline.Apply(componentList);
+}
 
-	componentList = newComponentList;
+bool HasAlternatives(const std::vector<DataFilter*>& filters)
+{
+	foreach(DataFilter* filter, filters)
+		if(filter->combination == DataFilter::OR)
+			return true;
+	return false;
 }
 
 DataViewer::DataViewer(const View& view, System* owningSystem):
 	currentViewDefinition(view),
 	owningSystem(owningSystem),
-	attributesCached(false)
+	lists(new ComponentLists),
+	attributesCached(false),
+	accessedCount(0)
 {
 	currentViewDefinition.clearFilters();
 	update(view);
 }
 
 DataViewer::DataViewer(const DataViewer& ref, System* owningSystem):
-	components(ref.components),
 	currentViewDefinition(ref.currentViewDefinition),
-	filteredComponents(ref.filteredComponents),
 	owningSystem(owningSystem),
-	attributesCached(false)
+	lists(ref.lists),
+	attributesCached(false),
+	filterPipeline(ref.filterPipeline),
+	accessedCount(0)
 {
-
+	// the shared lists may still hold components replaced in the predecessor state
+	QMutexLocker ml(&ref.mutex);
+	copies = ref.copies;
 }
 
 const std::vector<Component*>& DataViewer::getComponents()
@@ -126,9 +84,61 @@ const std::vector<Component*>& DataViewer::getComponents()
 	if( sys != NULL && currentViewDefinition.writes())
 		this->migrateAllComponents(sys);
 
+	return getComponentsReadOnly();
+}
+
+const std::vector<Component*>& DataViewer::getComponentsReadOnly()
+{
+	applyCopies();
+
+	const std::vector<Component*>& filteredComponents = lists.constData()->filteredComponents;
+	foreach(const std::string& attributeName, currentViewDefinition.getReadAttributes())
+		Component::LoadAttributes(filteredComponents, attributeName);
+
+	if(filteredComponents.size() > accessedCount)
+		accessedCount = filteredComponents.size();
 	return filteredComponents;
 }
 
+Component* DataViewer::getWritable(Component* component)
+{
+	if(component->getCurrentSystem() == owningSystem)
+		return component;
+
+	DerivedSystem* sys = dynamic_cast<DerivedSystem*>(owningSystem);
+	if(!sys)
+		return component;
+
+	{
+		QMutexLocker ml(&mutex);
+		if(Component* copy = copies.value(component, NULL))
+			return copy;
+	}
+	// the system locks the viewers while copying, don't hold our lock here.
+	// The copy registers itself, existing copies are found by name
+	Component* copy = sys->getComponentByName(component->getNameUUID());
+	return copy ? copy : component;
+}
+
+void DataViewer::registerCopy(const Component* src, Component* copy)
+{
+	QMutexLocker ml(&mutex);
+	copies[src] = copy;
+}
+
+void DataViewer::applyCopies()
+{
+	QMutexLocker ml(&mutex);
+	if(copies.size() == 0)
+		return;
+
+	for(std::vector<Component*>::iterator it = lists->components.begin(); it != lists->components.end(); ++it)
+		*it = copies.value(*it, *it);
+	for(std::vector<Component*>::iterator it = lists->filteredComponents.begin(); it != lists->filteredComponents.end(); ++it)
+		*it = copies.value(*it, *it);
+	copies.clear();
+}
+
 void DataViewer::addComponent(Component* component)
 {
 	if(!owningSystem->hasChild(component))
@@ -157,27 +167,33 @@ void DataViewer::addComponent(Component* component)
 			return;
 		}
 	}
-	components.push_back(component);
+	lists->components.push_back(component);
 
-	bool isValid = true;
-	foreach(DataFilter* filter, currentViewDefinition.getFilters())
-		if(!ApplyFilter(component, filter))
-			isValid = false;
-
-	if(isValid)
-		filteredComponents.push_back(component);
+	if(!filterPipeline.empty())
+	{
+		// the component may come with attributes moved to the db
+		filterPipeline.LoadAttributes(std::vector<Component*>(1, component));
+		if(!filterPipeline.Passes(component))
+			return;
+	}
+	lists->filteredComponents.push_back(component);
 }
 
 bool DataViewer::removeComponent(Component* component)
 {
-	std::vector<Component*>::iterator it = find(components.begin(), components.end(), component);
-	if(it != components.end())
-	{
-		components.erase(it);
-		filteredComponents.erase(find(filteredComponents.begin(), filteredComponents.end(), component));
-		return true;
-	}
-	return false;
+	applyCopies();
+
+	const std::vector<Component*>& constComponents = lists.constData()->components;
+	if(find(constComponents.begin(), constComponents.end(), component) == constComponents.end())
+		return false;
+
+	std::vector<Component*>& components = lists->components;
+	std::vector<Component*>& filteredComponents = lists->filteredComponents;
+	components.erase(find(components.begin(), components.end(), component));
+	std::vector<Component*>::iterator it = find(filteredComponents.begin(), filteredComponents.end(), component);
+	if(it != filteredComponents.end())
+		filteredComponents.erase(it);
+	return true;
 }
 
 void DataViewer::update(const View& view)
@@ -205,35 +221,38 @@ void DataViewer::update(const View& view)
 		}
 	}
 	
+	std::vector<DataFilter*> newFilters;
+	foreach(DataFilter* newFilter, view.getFilters())
+	{
+		bool isNew = true;
+		foreach(DataFilter* oldFilter, currentViewDefinition.getFilters())
+			if(*oldFilter == *newFilter)
+			{
+				isNew = false;
+				break;
+			}
+
+		if(isNew)
+			newFilters.push_back(newFilter);
+	}
+	// alternatives may add components, they can't be applied to filteredComponents
+	if(newFilters.size() && HasAlternatives(view.getFilters()))
+		renewFilteredComponents = true;
+
 	this->attributesCached = true;
 	if(renewFilteredComponents)
 	{
 		// recreate filteredComponents
-		filteredComponents = components;
-		ApplyFilters(filteredComponents, view.getFilters());
+		lists->filteredComponents = lists.constData()->components;
+		ApplyFilters(lists->filteredComponents, view.getFilters());
 	}
-	else
-	{
+	else if(newFilters.size())
 		// adapt filteredComponents
-		std::vector<DataFilter*> newFilters;
-		foreach(DataFilter* newFilter, view.getFilters())
-		{
-			bool isNew = true;
-			foreach(DataFilter* oldFilter, currentViewDefinition.getFilters())
-				if(*oldFilter == *newFilter)
-				{
-					isNew = false;
-					break;
-				}
-
-			if(isNew)
-				newFilters.push_back(newFilter);
-		}
+		ApplyFilters(lists->filteredComponents, newFilters);
 
-		ApplyFilters(filteredComponents, newFilters);
-	}
 	// update view definition
 	currentViewDefinition = view;
+	filterPipeline = DataFilterPipeline(currentViewDefinition.getFilters());
 	// update attribute cache
 	if(renewFilteredComponents)
 	{
@@ -244,6 +263,8 @@ void DataViewer::migrateComponent(const Component* src, Component* dest)
 {
 	if(src != dest && dest != NULL)
 	{
+		std::vector<Component*>& components = lists->components;
+		std::vector<Component*>& filteredComponents = lists->filteredComponents;
 		std::vector<Component*>::iterator it = find(components.begin(), components.end(), src);
 		if(it != components.end())
 			*it = dest;
@@ -255,10 +276,36 @@ void DataViewer::migrateComponent(const Component* src, Component* dest)
 
 void DataViewer::migrateAllComponents(DerivedSystem* targetSystem)
 {
-	// copy stuff from successor
-	foreach(Component* c, components)
+	applyCopies();
+
+	// nothing to copy, keep sharing the lists
+	const std::vector<Component*>& constComponents = lists.constData()->components;
+	unsigned int first = 0;
+	while(first < constComponents.size() && constComponents[first]->getCurrentSystem() == owningSystem)
+		first++;
+	if(first == constComponents.size())
+		return;
+
+	// copy stuff from successor, replacing all copies in one pass instead of searching each one.
+	// Copies are looked up by name, some may have been created by name lookups of the system already
+	std::vector<Component*>& components = lists->components;
+	QHash<const Component*, Component*> migrated;
+	for(unsigned int i=first;i<components.size();i++)
+	{
+		Component* c = components[i];
 		if(c->getCurrentSystem() != owningSystem)
-			this->migrateComponent(c, targetSystem->SuccessorCopyTypesafe(c));
+		{
+			Component* copy = targetSystem->getComponentByName(c->getNameUUID());
+			if(copy && copy != c)
+			{
+				migrated[c] = copy;
+				components[i] = copy;
+			}
+		}
+	}
+	if(migrated.size())
+		for(std::vector<Component*>::iterator it = lists->filteredComponents.begin(); it != lists->filteredComponents.end(); ++it)
+			*it = migrated.value(*it, *it);
 }
 
 const View* DataViewer::getCurrentViewDefinition()
@@ -28,7 +28,12 @@
 
 #include <string>
 #include <vector>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QHash>
+#include <QMutex>
 #include "dmview.h"
+#include "dmdatafilter.h"
 
 namespace DM {
 	
@@ -43,7 +48,17 @@ public:
 	DataViewer(const DataViewer& ref, System* owningSystem);
 	
 	const View*	getCurrentViewDefinition();
+	// components to be changed, a writing view copies all of them into the owning successor state
 	const std::vector<Component*>& getComponents();
+	// components which must not be changed, nothing is copied. Use getWritable before changing one
+	const std::vector<Component*>& getComponentsReadOnly();
+	// returns the component itself if it belongs to the owning system, otherwise its copy in the
+	// owning successor state, which replaces the component in this view
+	Component*	getWritable(Component* component);
+	// src has been copied into the owning successor state, the copy replaces src if the view holds it
+	void	registerCopy(const Component* src, Component* copy);
+	// number of components handed out by getComponents and getComponentsReadOnly
+	unsigned int getAccessedCount() const {return accessedCount;}
 
 	void	addComponent(Component* component);
 	bool	removeComponent(Component* component);
@@ -55,11 +70,26 @@ private:
 	DataViewer(const DataViewer& ref){}	// prevent from copy without system init
 	View	currentViewDefinition;
 	System*	owningSystem;
-	
-	std::vector<Component*>	components;
-	std::vector<Component*>	filteredComponents;
+
+	struct ComponentLists: public QSharedData
+	{
+		std::vector<Component*>	components;
+		std::vector<Component*>	filteredComponents;
+	};
+	// shared with the viewers of the predecessor and successor states until one of them changes,
+	// read via constData to avoid the copy
+	QSharedDataPointer<ComponentLists>	lists;
+
+	// replaces components copied by getWritable in the component lists
+	void applyCopies();
 
 	bool attributesCached;
+	// filters of currentViewDefinition, for added components
+	DataFilterPipeline	filterPipeline;
+
+	mutable QMutex	mutex;
+	QHash<const Component*, Component*>	copies;	// copies of the owning state not applied to the lists yet
+	unsigned int	accessedCount;
 };
 
 }
@@ -0,0 +1,812 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <dmdbbackend.h>
+#include <dmdbconnector.h>
+#include <dmlogger.h>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtConcurrentRun>
+
+using namespace DM;
+
+DbBackend* DbBackend::Create(DBBackendType type)
+{
+	switch(type)
+	{
+	case SQLITE_FILE:	return new SqlBackend("");
+	case SQLITE_MEMORY:	return new SqlBackend(":memory:");
+	case BINARY_STORE:	return new BinaryBackend(false);
+	case MAPPED_FILE:	return new BinaryBackend(true);
+	}
+	return NULL;
+}
+
+/*
+*  SQL BACKEND
+*/
+SqlBackend::SqlBackend(QString databaseName)
+{
+	this->databaseName = databaseName;
+}
+
+bool SqlBackend::Open()
+{
+	databaseFile = databaseName;
+	if(databaseFile.isEmpty())
+	{
+		QDateTime time = QDateTime::currentDateTime();
+		databaseFile = QDir::tempPath() + "/dynamind" + time.toString("_yyMMdd_hhmmss_zzz")+".db";
+		if(QFile::exists(databaseFile))
+			QFile::remove(databaseFile);
+	}
+
+	QSqlDatabase _db = QSqlDatabase::addDatabase("QSQLITE");
+	_db.setDatabaseName(databaseFile);
+	if(!_db.open())
+	{
+		Logger(Error) << "Failed to open db connection";
+
+		QSqlError e = _db.lastError();
+		Logger(Error) << "driver error: " << e.driverText();
+		Logger(Error) << "database error: " << e.databaseText();
+		return false;
+	}
+	else
+		Logger(Debug) << "Db connection opened";
+
+	// init table structure
+	if(!DropTables() || !CreateTables())
+	{
+		Logger(Error) << "Cannot initialize db tables";
+		DropTables();
+		_db.close();
+		QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+		return false;
+	}
+	Logger(Debug) << "DB created";
+	return true;
+}
+
+void SqlBackend::Close()
+{
+	{
+		QSqlDatabase _db = QSqlDatabase::database();
+		_db.close();
+	}
+	QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+
+	if(databaseName.isEmpty() && QFile::exists(databaseFile))
+		QFile::remove(databaseFile);
+}
+
+bool SqlBackend::CreateTables()
+{
+	QSqlQuery query;
+
+	if(        query.exec("PRAGMA synchronous=OFF")
+		&& query.exec("PRAGMA count_changes=OFF")
+		// && query.exec("PRAGMA page_size=5120")
+		&& query.exec("PRAGMA journal_mode=OFF")
+		&& query.exec("PRAGMA temp_store=OFF")
+		// && query.exec("PRAGMA cache_size=50000")
+		&& query.exec("CREATE TABLE systems(	uuid BINARY(16) NOT NULL, \
+					  owner BINARY16, \
+					  predecessors TEXT, \
+					  sucessors TEXT, \
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE components(uuid BINARY(16) NOT NULL, \
+					  owner BINARY(16), \
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE nodes(uuid BINARY(16) NOT NULL, \
+					  owner BINARY(16), \
+					  x DOUBLE PRECISION, y DOUBLE PRECISION, z DOUBLE PRECISION, \
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE edges(uuid BINARY(16) NOT NULL, \
+					  owner BINARY(16), \
+					  startnode BINARY(16), \
+					  endnode BINARY(16), \
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE faces(uuid BINARY(16) NOT NULL, \
+					  owner BINARY(16), \
+					  nodes TEXT, \
+					  holes TEXT, \
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE rasterdatas(uuid BINARY(16) NOT NULL, \
+					  owner BINARY(16), \
+					  datalink INT,\
+					  PRIMARY KEY (uuid))")
+		&& query.exec("CREATE TABLE rasterfields(owner BINARY(16) NOT NULL, \
+					  x BIGINT, \
+					  y BIGINT, \
+					  data BYTEA, \
+					  PRIMARY KEY (owner,x,y))")
+		&& query.exec("CREATE TABLE attributes(\
+					  owner BINARY(16) NOT NULL, \
+					  name VARCHAR(128) NOT NULL, \
+					  type SMALLINT, \
+					  value BYTEA, \
+					  PRIMARY KEY (owner, name))")
+					  )
+			return true;
+
+	PrintSqlError(&query);
+	return false;
+}
+
+bool SqlBackend::DropTables()
+{
+	QSqlQuery query;
+	if(	query.exec("DROP TABLE IF EXISTS systems")
+		&&	query.exec("DROP TABLE IF EXISTS components")
+		&&	query.exec("DROP TABLE IF EXISTS nodes")
+		&&	query.exec("DROP TABLE IF EXISTS edges")
+		&&	query.exec("DROP TABLE IF EXISTS faces")
+		&&	query.exec("DROP TABLE IF EXISTS rasterdatas")
+		&&	query.exec("DROP TABLE IF EXISTS rasterfields")
+		&&	query.exec("DROP TABLE IF EXISTS attributes")
+		)
+		return true;
+
+	PrintSqlError(&query);
+	return false;
+}
+
+void SqlBackend::SaveAttribute(const QUuid& owner, const QString& name,
+							   int type, const QVariant& value, bool isInserted)
+{
+	QVariant qval = value;
+	QVariant qtype = QVariant::fromValue(type);
+
+	if(isInserted)
+	{
+		DBConnector::getInstance()->Update(
+			"attributes",	owner, name,
+			"type",			&qtype,
+			"value",		&qval);
+	}
+	else
+	{
+		DBConnector::getInstance()->Insert(
+			"attributes",	owner, name,
+			"type",			&qtype,
+			"value",		&qval);
+	}
+}
+
+bool SqlBackend::LoadAttribute(const QUuid& owner, const QString& name,
+							   int* type, QVariant* value)
+{
+	QVariant t;
+	bool found = DBConnector::getInstance()->Select("attributes", owner, name,
+		"type",     &t,
+		"value",    value);
+	*type = t.toInt();
+	return found;
+}
+
+void SqlBackend::LoadAttributes(const QList<QUuid>& owners, const QString& name,
+								QList<int>* types, QList<QVariant>* values)
+{
+	QList<QVariant> keys;
+	foreach(const QUuid& owner, owners)
+		keys.append(owner.toByteArray());
+
+	QList<QVariant> conditionValues;
+	conditionValues.append(name);
+
+	QList<QList<QVariant> > rows;
+	DBConnector::getInstance()->SelectIn("attributes", "owner", keys, "type,value", &rows,
+		"name=?", conditionValues);
+
+	QHash<QByteArray, int> rowIndex;
+	for(int i=0;i<rows.size();i++)
+		rowIndex[rows[i].at(0).toByteArray()] = i;
+
+	for(int i=0;i<keys.size();i++)
+	{
+		int row = rowIndex.value(keys[i].toByteArray(), -1);
+		if(row >= 0)
+		{
+			types->append(rows[row].at(1).toInt());
+			values->append(rows[row].at(2));
+		}
+		else
+		{
+			types->append(0);
+			values->append(QVariant());
+		}
+	}
+}
+
+void SqlBackend::DeleteAttribute(const QUuid& owner, const QString& name)
+{
+	DBConnector::getInstance()->Delete("attributes", owner, name);
+}
+
+void SqlBackend::SaveRasterBlock(const QUuid& owner, long x, long y,
+								 const QByteArray& data, bool isInserted)
+{
+	if(!isInserted)
+	{
+		QSqlQuery *q = DBConnector::getInstance()->getQuery("INSERT INTO rasterfields(owner,x,y,data) VALUES (?,?,?,?)");
+		q->addBindValue(owner.toByteArray());
+		q->addBindValue(QVariant::fromValue(x));
+		q->addBindValue(QVariant::fromValue(y));
+		q->addBindValue(data);
+		DBConnector::getInstance()->ExecuteQuery(q);
+	}
+	else
+	{
+		QSqlQuery *q = DBConnector::getInstance()->getQuery("UPDATE rasterfields SET data=? WHERE owner=? AND x=? AND y=?");
+		q->addBindValue(data);
+		q->addBindValue(owner.toByteArray());
+		q->addBindValue(QVariant::fromValue(x));
+		q->addBindValue(QVariant::fromValue(y));
+		DBConnector::getInstance()->ExecuteQuery(q);
+	}
+}
+
+QByteArray* SqlBackend::LoadRasterBlock(const QUuid& owner, long x, long y)
+{
+	QSqlQuery *q = DBConnector::getInstance()->getQuery("SELECT data FROM rasterfields WHERE owner LIKE ? AND x=? AND y=?");
+	q->addBindValue(owner.toByteArray());
+	q->addBindValue(QVariant::fromValue(x));
+	q->addBindValue(QVariant::fromValue(y));
+	// the query is deleted by the worker
+	QList<QList<QVariant> > rows;
+	if(!DBConnector::getInstance()->ExecuteSelectQuery(q, &rows))
+		return NULL;
+
+	return new QByteArray(rows.at(0).at(0).toByteArray());
+}
+
+void SqlBackend::LoadRasterBlocks(const QUuid& owner, long x, const QList<long>& ys,
+								  QList<QByteArray*>* data)
+{
+	QList<QVariant> keys;
+	foreach(long y, ys)
+		keys.append(QVariant::fromValue(y));
+
+	QList<QVariant> conditionValues;
+	conditionValues.append(owner.toByteArray());
+	conditionValues.append(QVariant::fromValue(x));
+
+	QList<QList<QVariant> > rows;
+	if(!DBConnector::getInstance()->SelectIn("rasterfields", "y", keys, "data", &rows,
+		"owner=? AND x=?", conditionValues))
+		return;
+
+	foreach(const QList<QVariant>& row, rows)
+	{
+		long y = row.at(0).toLongLong();
+		for(int i=0;i<ys.size();i++)
+		{
+			if(ys[i] == y && (*data)[i] == NULL)
+			{
+				(*data)[i] = new QByteArray(row.at(1).toByteArray());
+				break;
+			}
+		}
+	}
+}
+
+void SqlBackend::DeleteRasterField(const QUuid& owner)
+{
+	QSqlQuery *q = DBConnector::getInstance()->getQuery("DELETE FROM rasterfields WHERE owner LIKE ?");
+	if(q)
+	{
+		q->addBindValue(owner.toByteArray());
+		DBConnector::getInstance()->ExecuteQuery(q);
+	}
+}
+
+/*
+*  BINARY BACKEND
+*/
+// tags of the attribute value encoding
+#define VALUE_INVALID	'n'
+#define VALUE_DOUBLE	'd'
+#define VALUE_STRING	's'
+#define VALUE_BYTES		'b'
+#define VALUE_VARIANT	'v'
+
+BinaryBackend::BinaryBackend(bool mapped)
+{
+	this->mapped = mapped;
+	currentSegment = -1;
+	storedBytes = 0;
+	garbageBytes = 0;
+	compactionRunning = 0;
+}
+
+BinaryBackend::~BinaryBackend()
+{
+	Close();
+}
+
+bool BinaryBackend::Open()
+{
+	if(!mapped)
+		return true;
+
+	QDateTime time = QDateTime::currentDateTime();
+	directory = QDir::tempPath() + "/dynamind_spill" + time.toString("_yyMMdd_hhmmss_zzz");
+	if(!QDir().mkpath(directory))
+	{
+		Logger(Error) << "Failed to create spill directory " << directory;
+		return false;
+	}
+	return true;
+}
+
+void BinaryBackend::Close()
+{
+	WaitForCompaction();
+
+	QWriteLocker wl(&lock);
+	for(int i=0;i<segments.size();i++)
+		FreeSegment(i);
+	segments.clear();
+	currentSegment = -1;
+	storedBytes = 0;
+	garbageBytes = 0;
+	attributeIndex.clear();
+	rasterIndex.clear();
+
+	if(mapped && !directory.isEmpty())
+		QDir().rmdir(directory);
+}
+
+qint64 BinaryBackend::GetStoredBytes()
+{
+	QReadLocker rl(&lock);
+	return storedBytes;
+}
+
+qint64 BinaryBackend::GetGarbageBytes()
+{
+	QReadLocker rl(&lock);
+	return garbageBytes;
+}
+
+void BinaryBackend::WaitForCompaction()
+{
+	compaction.waitForFinished();
+}
+
+BinaryBackend::Segment* BinaryBackend::NewSegment(int size)
+{
+	Segment* seg = new Segment;
+	seg->size = size;
+	seg->fill = 0;
+	seg->garbage = 0;
+	seg->file = NULL;
+	seg->data = NULL;
+
+	if(mapped)
+	{
+		seg->file = new QFile(directory + "/segment" + QString::number(segments.size()));
+		uchar* p = NULL;
+		if(seg->file->open(QIODevice::ReadWrite) && seg->file->resize(size))
+			p = seg->file->map(0, size);
+
+		if(p)
+			seg->data = (char*)p;
+		else
+		{
+			Logger(Error) << "Failed to map spill segment, falling back to memory";
+			seg->file->remove();
+			delete seg->file;
+			seg->file = NULL;
+		}
+	}
+	if(!seg->data)
+		seg->data = new char[size];
+
+	storedBytes += size;
+	return seg;
+}
+
+void BinaryBackend::FreeSegment(int segment)
+{
+	Segment* seg = segments[segment];
+	if(!seg)
+		return;
+
+	if(seg->file)
+	{
+		seg->file->unmap((uchar*)seg->data);
+		seg->file->close();
+		seg->file->remove();
+		delete seg->file;
+	}
+	else
+		delete[] seg->data;
+
+	storedBytes -= seg->size;
+	garbageBytes -= seg->garbage;
+	delete seg;
+	segments[segment] = NULL;
+}
+
+BinaryBackend::Record BinaryBackend::Append(const QByteArray& key, const char* data, int length)
+{
+	int keyLength = key.size();
+	int recordSize = 2*sizeof(qint32) + keyLength + length;
+
+	if(currentSegment < 0 || segments[currentSegment]->fill + recordSize > segments[currentSegment]->size)
+	{
+		segments.append(NewSegment(qMax(recordSize, BINARYSTORE_SEGMENT_SIZE)));
+		currentSegment = segments.size()-1;
+	}
+	Segment* seg = segments[currentSegment];
+
+	Record r;
+	r.segment = currentSegment;
+	r.offset = seg->fill;
+	r.keyLength = keyLength;
+	r.length = length;
+
+	// record: key length, key, data length, data
+	char* p = seg->data + seg->fill;
+	qint32 size = keyLength;
+	memcpy(p, &size, sizeof(qint32));
+	p += sizeof(qint32);
+	memcpy(p, key.constData(), keyLength);
+	p += keyLength;
+	size = length;
+	memcpy(p, &size, sizeof(qint32));
+	p += sizeof(qint32);
+	memcpy(p, data, length);
+
+	seg->fill += recordSize;
+	return r;
+}
+
+inline const char* BinaryBackend::Data(const Record& r) const
+{
+	return segments[r.segment]->data + r.offset + 2*sizeof(qint32) + r.keyLength;
+}
+
+void BinaryBackend::Release(const Record& r)
+{
+	int recordSize = 2*sizeof(qint32) + r.keyLength + r.length;
+	segments[r.segment]->garbage += recordSize;
+	garbageBytes += recordSize;
+}
+
+void BinaryBackend::ScheduleCompaction()
+{
+	if(compactionRunning)
+		return;
+
+	bool worthIt = false;
+	{
+		QReadLocker rl(&lock);
+		for(int i=0;i<segments.size() && !worthIt;i++)
+			if(segments[i] && i != currentSegment
+				&& segments[i]->garbage >= segments[i]->size*BINARYSTORE_COMPACTION_RATIO)
+				worthIt = true;
+	}
+	if(worthIt && compactionRunning.testAndSetOrdered(0, 1))
+		compaction = QtConcurrent::run(this, &BinaryBackend::Compact);
+}
+
+void BinaryBackend::Compact()
+{
+	for(;;)
+	{
+		// one segment per lock, so readers and writers are not blocked for too long
+		QWriteLocker wl(&lock);
+		int segment = -1;
+		for(int i=0;i<segments.size();i++)
+		{
+			if(segments[i] && i != currentSegment
+				&& segments[i]->garbage >= segments[i]->size*BINARYSTORE_COMPACTION_RATIO)
+			{
+				segment = i;
+				break;
+			}
+		}
+		if(segment < 0)
+			break;
+
+		CompactSegment(segment);
+	}
+	compactionRunning = 0;
+}
+
+void BinaryBackend::CompactSegment(int segment)
+{
+	Segment* seg = segments[segment];
+	int offset = 0;
+	while(offset < seg->fill)
+	{
+		Record r;
+		r.segment = segment;
+		r.offset = offset;
+
+		qint32 size;
+		memcpy(&size, seg->data + offset, sizeof(qint32));
+		r.keyLength = size;
+		QByteArray key(seg->data + offset + sizeof(qint32), r.keyLength);
+		memcpy(&size, seg->data + offset + sizeof(qint32) + r.keyLength, sizeof(qint32));
+		r.length = size;
+		offset += 2*sizeof(qint32) + r.keyLength + r.length;
+
+		// find the index entry of the record, if it still points here the record is alive
+		Record* entry = NULL;
+		if(key.at(0) == 'a')
+		{
+			QHash<QByteArray, Record>::iterator it = attributeIndex.find(key);
+			if(it != attributeIndex.end())
+				entry = &it.value();
+		}
+		else
+		{
+			qint64 x, y;
+			memcpy(&x, key.constData() + key.size() - 2*sizeof(qint64), sizeof(qint64));
+			memcpy(&y, key.constData() + key.size() - sizeof(qint64), sizeof(qint64));
+			QHash<QByteArray, QHash<BlockKey, Record> >::iterator field =
+				rasterIndex.find(key.mid(1, key.size() - 1 - 2*sizeof(qint64)));
+			if(field != rasterIndex.end())
+			{
+				QHash<BlockKey, Record>::iterator it = field.value().find(BlockKey(x,y));
+				if(it != field.value().end())
+					entry = &it.value();
+			}
+		}
+
+		if(entry && entry->segment == segment && entry->offset == r.offset)
+			*entry = Append(key, Data(r), r.length);
+	}
+	FreeSegment(segment);
+}
+
+QByteArray BinaryBackend::AttributeKey(const QUuid& owner, const QString& name)
+{
+	return QByteArray("a") + owner.toByteArray() + name.toUtf8();
+}
+
+QByteArray BinaryBackend::BlockRecordKey(const QByteArray& owner, long x, long y)
+{
+	qint64 coords[2] = {x, y};
+	return QByteArray("r") + owner + QByteArray((const char*)coords, sizeof(coords));
+}
+
+void BinaryBackend::SaveAttribute(const QUuid& owner, const QString& name,
+								  int type, const QVariant& value, bool isInserted)
+{
+	// type, tag and the value, binary values are copied as they are
+	QByteArray record;
+	qint32 t = type;
+	record.append((const char*)&t, sizeof(qint32));
+	switch(value.type())
+	{
+	case QVariant::Invalid:
+		record.append(VALUE_INVALID);
+		break;
+	case QVariant::Double:
+		{
+			double d = value.toDouble();
+			record.append(VALUE_DOUBLE);
+			record.append((const char*)&d, sizeof(double));
+		}
+		break;
+	case QVariant::String:
+		{
+			QString str = value.toString();
+			record.append(VALUE_STRING);
+			record.append((const char*)str.constData(), str.size()*sizeof(QChar));
+		}
+		break;
+	case QVariant::ByteArray:
+		record.append(VALUE_BYTES);
+		record.append(value.toByteArray());
+		break;
+	default:
+		{
+			record.append(VALUE_VARIANT);
+			QByteArray bytes;
+			QDataStream stream(&bytes, QIODevice::WriteOnly);
+			stream << value;
+			record.append(bytes);
+		}
+		break;
+	}
+
+	QByteArray key = AttributeKey(owner, name);
+	bool replaced = false;
+	{
+		QWriteLocker wl(&lock);
+		QHash<QByteArray, Record>::iterator it = attributeIndex.find(key);
+		if(it != attributeIndex.end())
+		{
+			Release(it.value());
+			it.value() = Append(key, record.constData(), record.size());
+			replaced = true;
+		}
+		else
+			attributeIndex[key] = Append(key, record.constData(), record.size());
+	}
+	if(replaced)
+		ScheduleCompaction();
+}
+
+bool BinaryBackend::ReadAttribute(const QByteArray& key, int* type, QVariant* value)
+{
+	QHash<QByteArray, Record>::const_iterator it = attributeIndex.find(key);
+	if(it == attributeIndex.end())
+	{
+		*type = 0;
+		*value = QVariant();
+		return false;
+	}
+
+	const char* data = Data(it.value());
+	int length = it.value().length - sizeof(qint32) - 1;
+	qint32 t;
+	memcpy(&t, data, sizeof(qint32));
+	*type = t;
+	char tag = data[sizeof(qint32)];
+	data += sizeof(qint32) + 1;
+
+	switch(tag)
+	{
+	case VALUE_DOUBLE:
+		{
+			double d;
+			memcpy(&d, data, sizeof(double));
+			*value = QVariant::fromValue(d);
+		}
+		break;
+	case VALUE_STRING:
+		*value = QString((const QChar*)data, length/(int)sizeof(QChar));
+		break;
+	case VALUE_BYTES:
+		*value = QByteArray(data, length);
+		break;
+	case VALUE_VARIANT:
+		{
+			QByteArray bytes(data, length);
+			QDataStream stream(&bytes, QIODevice::ReadOnly);
+			stream >> *value;
+		}
+		break;
+	default:
+		*value = QVariant();
+		break;
+	}
+	return true;
+}
+
+bool BinaryBackend::LoadAttribute(const QUuid& owner, const QString& name,
+								  int* type, QVariant* value)
+{
+	QReadLocker rl(&lock);
+	return ReadAttribute(AttributeKey(owner, name), type, value);
+}
+
+void BinaryBackend::LoadAttributes(const QList<QUuid>& owners, const QString& name,
+								   QList<int>* types, QList<QVariant>* values)
+{
+	QReadLocker rl(&lock);
+	foreach(const QUuid& owner, owners)
+	{
+		int type;
+		QVariant value;
+		ReadAttribute(AttributeKey(owner, name), &type, &value);
+		types->append(type);
+		values->append(value);
+	}
+}
+
+void BinaryBackend::DeleteAttribute(const QUuid& owner, const QString& name)
+{
+	{
+		QWriteLocker wl(&lock);
+		QHash<QByteArray, Record>::iterator it = attributeIndex.find(AttributeKey(owner, name));
+		if(it == attributeIndex.end())
+			return;
+
+		Release(it.value());
+		attributeIndex.erase(it);
+	}
+	ScheduleCompaction();
+}
+
+void BinaryBackend::SaveRasterBlock(const QUuid& owner, long x, long y,
+									const QByteArray& data, bool isInserted)
+{
+	QByteArray ownerKey = owner.toByteArray();
+	QByteArray key = BlockRecordKey(ownerKey, x, y);
+	bool replaced = false;
+	{
+		QWriteLocker wl(&lock);
+		QHash<BlockKey, Record>& blocks = rasterIndex[ownerKey];
+		QHash<BlockKey, Record>::iterator it = blocks.find(BlockKey(x,y));
+		if(it != blocks.end())
+		{
+			Release(it.value());
+			it.value() = Append(key, data.constData(), data.size());
+			replaced = true;
+		}
+		else
+			blocks[BlockKey(x,y)] = Append(key, data.constData(), data.size());
+	}
+	if(replaced)
+		ScheduleCompaction();
+}
+
+QByteArray* BinaryBackend::LoadRasterBlock(const QUuid& owner, long x, long y)
+{
+	QReadLocker rl(&lock);
+	QHash<QByteArray, QHash<BlockKey, Record> >::const_iterator field = rasterIndex.find(owner.toByteArray());
+	if(field == rasterIndex.end())
+		return NULL;
+
+	QHash<BlockKey, Record>::const_iterator it = field.value().find(BlockKey(x,y));
+	if(it == field.value().end())
+		return NULL;
+
+	return new QByteArray(Data(it.value()), it.value().length);
+}
+
+void BinaryBackend::LoadRasterBlocks(const QUuid& owner, long x, const QList<long>& ys,
+									 QList<QByteArray*>* data)
+{
+	QReadLocker rl(&lock);
+	QHash<QByteArray, QHash<BlockKey, Record> >::const_iterator field = rasterIndex.find(owner.toByteArray());
+	if(field == rasterIndex.end())
+		return;
+
+	for(int i=0;i<ys.size();i++)
+	{
+		QHash<BlockKey, Record>::const_iterator it = field.value().find(BlockKey(x,ys[i]));
+		if(it != field.value().end() && (*data)[i] == NULL)
+			(*data)[i] = new QByteArray(Data(it.value()), it.value().length);
+	}
+}
+
+void BinaryBackend::DeleteRasterField(const QUuid& owner)
+{
+	{
+		QWriteLocker wl(&lock);
+		QHash<QByteArray, QHash<BlockKey, Record> >::iterator field = rasterIndex.find(owner.toByteArray());
+		if(field == rasterIndex.end())
+			return;
+
+		foreach(const Record& r, field.value())
+			Release(r);
+		rasterIndex.erase(field);
+	}
+	ScheduleCompaction();
+}
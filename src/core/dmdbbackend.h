@@ -0,0 +1,249 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef DMDBBACKEND_H
+#define DMDBBACKEND_H
+
+#include <dmcompilersettings.h>
+#include <QUuid>
+#include <QString>
+#include <QVariant>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QFuture>
+
+class QFile;
+
+namespace DM {
+
+enum DBBackendType
+{
+	SQLITE_FILE,	//!< sqlite database in a temporary file
+	SQLITE_MEMORY,	//!< sqlite database in memory
+	BINARY_STORE,	//!< in-process append-only binary store, no sql
+	MAPPED_FILE		//!< append-only binary store in memory mapped segment files, no sql
+};
+
+/**************************************************************//**
+@class DM::DbBackend
+@ingroup DynaMind-Core
+@brief Storage for data moved out of memory: attributes and raster
+blocks. The backend is selected via DBConnectorConfig::backend.
+
+COMMENTS
+Attributes are identified by owner and name, raster blocks by the
+owning raster and the block coordinates. The component tables and
+raw queries of DBConnector are only available on sql backends.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT DbBackend
+{
+public:
+	virtual ~DbBackend(){}
+	//!< opens the storage, returns false on failure
+	virtual bool Open() = 0;
+	//!< closes the storage, all stored data is discarded
+	virtual void Close() = 0;
+	//!< returns true if the backend is a sql database
+	virtual bool IsSql() const = 0;
+
+	//!< stores an attribute, isInserted tells if it has been stored before
+	virtual void SaveAttribute(const QUuid& owner, const QString& name,
+		int type, const QVariant& value, bool isInserted) = 0;
+	//!< loads an attribute, returns false if it is not stored
+	virtual bool LoadAttribute(const QUuid& owner, const QString& name,
+		int* type, QVariant* value) = 0;
+	//!< loads the attribute of all owners, types[i] is 0 (NOTYPE) if owners[i] has no stored attribute
+	virtual void LoadAttributes(const QList<QUuid>& owners, const QString& name,
+		QList<int>* types, QList<QVariant>* values) = 0;
+	virtual void DeleteAttribute(const QUuid& owner, const QString& name) = 0;
+
+	//!< stores a raster block, isInserted tells if it has been stored before
+	virtual void SaveRasterBlock(const QUuid& owner, long x, long y,
+		const QByteArray& data, bool isInserted) = 0;
+	//!< loads a raster block, returns NULL if it is not stored
+	virtual QByteArray* LoadRasterBlock(const QUuid& owner, long x, long y) = 0;
+	//!< loads the blocks (x, ys[i]) of one raster column, data[i] stays NULL if the block is not stored
+	virtual void LoadRasterBlocks(const QUuid& owner, long x, const QList<long>& ys,
+		QList<QByteArray*>* data) = 0;
+	//!< removes all blocks of a raster
+	virtual void DeleteRasterField(const QUuid& owner) = 0;
+
+	//!< creates a new, not opened backend of the given type
+	static DbBackend* Create(DBBackendType type);
+};
+
+/**************************************************************//**
+@class DM::SqlBackend
+@ingroup DynaMind-Core
+@brief Stores data in a sqlite database via the DBConnector worker.
+
+COMMENTS
+An empty database name creates a new file in the temp directory,
+":memory:" keeps the database in memory.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT SqlBackend: public DbBackend
+{
+public:
+	SqlBackend(QString databaseName);
+
+	bool Open();
+	void Close();
+	bool IsSql() const {return true;}
+
+	void SaveAttribute(const QUuid& owner, const QString& name,
+		int type, const QVariant& value, bool isInserted);
+	bool LoadAttribute(const QUuid& owner, const QString& name,
+		int* type, QVariant* value);
+	void LoadAttributes(const QList<QUuid>& owners, const QString& name,
+		QList<int>* types, QList<QVariant>* values);
+	void DeleteAttribute(const QUuid& owner, const QString& name);
+
+	void SaveRasterBlock(const QUuid& owner, long x, long y,
+		const QByteArray& data, bool isInserted);
+	QByteArray* LoadRasterBlock(const QUuid& owner, long x, long y);
+	void LoadRasterBlocks(const QUuid& owner, long x, const QList<long>& ys,
+		QList<QByteArray*>* data);
+	void DeleteRasterField(const QUuid& owner);
+private:
+	bool CreateTables();
+	bool DropTables();
+
+	QString databaseName;
+	QString databaseFile;
+};
+
+// segment size of the binary store in bytes, records bigger than a segment get their own one
+#define BINARYSTORE_SEGMENT_SIZE (16*1024*1024)
+
+// a full segment is compacted in the background as soon as this fraction of it is garbage
+#define BINARYSTORE_COMPACTION_RATIO 0.5
+
+/**************************************************************//**
+@class DM::BinaryBackend
+@ingroup DynaMind-Core
+@brief Stores data in an append-only log without any sql, either in
+memory or in memory mapped segment files.
+
+COMMENTS
+Records are appended to fixed size segments and never changed. An
+update appends a new version and moves the index entry, the old
+version becomes garbage. Each record starts with its key, so a full
+segment with mostly garbage can be compacted by walking it and
+copying the records still referenced by the index to the current
+segment. Compaction runs in the background, afterwards the segment
+is freed, mapped segment files are removed.
+Raster blocks and binary attribute values are copied with memcpy,
+only other attribute values are serialized via QDataStream.
+Writes are executed synchronously, there is no worker involved.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT BinaryBackend: public DbBackend
+{
+public:
+	//!< if mapped is set, segments are memory mapped files in the temp directory
+	BinaryBackend(bool mapped = false);
+	~BinaryBackend();
+
+	bool Open();
+	void Close();
+	bool IsSql() const {return false;}
+
+	void SaveAttribute(const QUuid& owner, const QString& name,
+		int type, const QVariant& value, bool isInserted);
+	bool LoadAttribute(const QUuid& owner, const QString& name,
+		int* type, QVariant* value);
+	void LoadAttributes(const QList<QUuid>& owners, const QString& name,
+		QList<int>* types, QList<QVariant>* values);
+	void DeleteAttribute(const QUuid& owner, const QString& name);
+
+	void SaveRasterBlock(const QUuid& owner, long x, long y,
+		const QByteArray& data, bool isInserted);
+	QByteArray* LoadRasterBlock(const QUuid& owner, long x, long y);
+	void LoadRasterBlocks(const QUuid& owner, long x, const QList<long>& ys,
+		QList<QByteArray*>* data);
+	void DeleteRasterField(const QUuid& owner);
+
+	//!< bytes of all allocated segments
+	qint64 GetStoredBytes();
+	//!< bytes of records which have been replaced or deleted and not compacted yet
+	qint64 GetGarbageBytes();
+	//!< blocks until the running compaction, if any, is finished
+	void WaitForCompaction();
+private:
+	struct Segment
+	{
+		char*	data;
+		int		size;
+		int		fill;
+		int		garbage;
+		QFile*	file;	// NULL for in memory segments
+	};
+	struct Record
+	{
+		int segment;
+		int offset;		// start of the record header
+		int keyLength;
+		int length;		// length of the data
+	};
+	typedef QPair<qint64,qint64> BlockKey;
+
+	Segment* NewSegment(int size);
+	void FreeSegment(int segment);
+	// appends a record to the current segment, needs the write lock
+	Record Append(const QByteArray& key, const char* data, int length);
+	inline const char* Data(const Record& r) const;
+	// marks the record as garbage, needs the write lock
+	void Release(const Record& r);
+
+	static QByteArray AttributeKey(const QUuid& owner, const QString& name);
+	static QByteArray BlockRecordKey(const QByteArray& owner, long x, long y);
+	bool ReadAttribute(const QByteArray& key, int* type, QVariant* value);
+
+	// starts a background compaction if a segment is worth it
+	void ScheduleCompaction();
+	void Compact();
+	// copies all live records of the segment to the current one, needs the write lock
+	void CompactSegment(int segment);
+
+	bool	mapped;
+	QString directory;
+	QReadWriteLock lock;
+	QList<Segment*> segments;	// freed segments stay NULL to keep the ids
+	int		currentSegment;
+	qint64	storedBytes;
+	qint64	garbageBytes;
+	QAtomicInt compactionRunning;
+	QFuture<void> compaction;
+
+	QHash<QByteArray, Record> attributeIndex;
+	QHash<QByteArray, QHash<BlockKey, Record> > rasterIndex;	// key: owner uuid
+};
+
+}	// namespace DM
+
+#endif // DMDBBACKEND_H
@@ -2,6 +2,7 @@
 #define DMDBCACHE_H
 
 #include <dmcache.h>
+#include <dmdbconnector.h>
 
 /**************************************************************//**
 @class DM::DbCache
@@ -12,6 +13,8 @@ is not found.
 The key class has to implement:
 Tkey::SaveToDb(Tvalue);
 Tkey::LoadFromDb();
+for preCache additionally:
+static Tkey::_PreCache(const QList<Tkey>& keys, QList<Tvalue*>& values);
 
 COMMENTS
 Inherits DM::Asynchron
@@ -22,103 +25,109 @@ namespace DM {
 template<class Tkey,class Tvalue>
 class DbCache: public Cache<Tkey,Tvalue>, Asynchron
 {
+	typedef typename Cache<Tkey,Tvalue>::Node Node;
+	typedef typename Cache<Tkey,Tvalue>::Shard Shard;
+
 	//!< Save all elements to db, called by DBConnector
 	void Synchronize()
 	{
 #ifdef NO_DB_SYNC
-		return
+		return;
 #endif
-
-			Node* n=Cache<Tkey,Tvalue>::_root;
-		while(n)
+		for(unsigned int i=0;i<this->shardCount;i++)
 		{
-			n->key->SaveToDb(n->value);
-			n = n->next;
+			Shard* s = this->shards[i];
+			s->mutex.lockInline();
+			for(Node* n=s->lru._root;n;n=n->next)
+				n->key->SaveToDb(n->value);
+			for(Node* n=s->fifo._root;n;n=n->next)
+				n->key->SaveToDb(n->value);
+			s->mutex.unlockInline();
 		}
 	}
+protected:
+	//!< elements dropped due to the size limit are saved to db
+	void evict(Node* n)
+	{
+		n->key->SaveToDb(n->value);
+	}
 public:
-	typedef typename Cache<Tkey,Tvalue>::Node Node;
 	//!< initializes a new cache with the given size, 0 results in an infinite cache
-	DbCache(unsigned long size): Cache<Tkey,Tvalue>(size){}
+	DbCache(unsigned long size, CachePolicy policy = CACHE_LRU): Cache<Tkey,Tvalue>(size, policy){}
 	//!< add a new key-value pair, calls SaveToDb if last element is dropped
-	void add(Tkey key,Tvalue* value)
+	void add(const Tkey& key,Tvalue* value)
 	{
-		this->mutex->lockInline();
-		if(Cache<Tkey,Tvalue>::search(key)!=NULL)
+		Shard* s = this->shardOf(key);
+		s->mutex.lockInline();
+		if(s->search(key)!=NULL)
 		{
-			this->mutex->unlockInline();
+			s->mutex.unlockInline();
 			return;
 		}
 
-		Node *n = Cache<Tkey,Tvalue>::newNode(key,value);
-		Cache<Tkey,Tvalue>::push_front(n);
+		s->insert(key,value);
 
-		if(Cache<Tkey,Tvalue>::_size)
-		{
-			if(Cache<Tkey,Tvalue>::_cnt > Cache<Tkey,Tvalue>::_size)
-			{
-				for(unsigned long i=0;i<DBConnector::getInstance()->GetCacheBlockwritingSize()
-					&& Cache<Tkey,Tvalue>::_cnt>1;i++)
-				{
-					Cache<Tkey,Tvalue>::_last->key->SaveToDb(Cache<Tkey,Tvalue>::_last->value);
-					Cache<Tkey,Tvalue>::removeNode(Cache<Tkey,Tvalue>::_last);
-				}
-			}
-		}
-		this->mutex->unlockInline();
+		// write a whole block at once, keeping at least the new element
+		if((this->_shardSize && s->count() > this->_shardSize) || this->overBudget(s))
+			this->shrink(s, std::min(DBConnector::getInstance()->GetCacheBlockwritingSize(), s->count()-1));
+
+		s->mutex.unlockInline();
 	}
 	//!< returns the value associated with the given key, if not found LoadFromDb is called. Neither found in db, returns NULL
 	Tvalue* get(const Tkey& key)
 	{
-		this->mutex->lockInline();
+		Shard* s = this->shardOf(key);
+		s->mutex.lockInline();
 		Tvalue* v = Cache<Tkey,Tvalue>::get(key);
 		if(!v)
 		{
 			v = key->LoadFromDb();
 			if(v)   add(key,v);
 		}
-		this->mutex->unlockInline();
+		s->mutex.unlockInline();
 		return v;
 	}
 	// NOTE: currently removing from db is handled by the main class
 	// void remove(const Tkey& key)
 
-	//<! resizes the cache, if the given value is 0, the cache is set to infinite
-	void resize(unsigned long size)
+	//!< loads all given keys which are not cached yet with a single bulk request via Tkey::_PreCache
+	void preCache(const QList<Tkey>& keys)
 	{
-		this->mutex->lockInline();
-		Cache<Tkey,Tvalue>::_size = size;
-
-		if(Cache<Tkey,Tvalue>::_size)
+		QList<Tkey> missingKeys;
+		foreach(Tkey key, keys)
 		{
-			while(Cache<Tkey,Tvalue>::_cnt > size)
-			{
-				Cache<Tkey,Tvalue>::_last->key->SaveToDb(Cache<Tkey,Tvalue>::_last->value);
-				Cache<Tkey,Tvalue>::removeNode(Cache<Tkey,Tvalue>::_last);
-			}
+			Shard* s = this->shardOf(key);
+			s->mutex.lockInline();
+			if(s->search(key) == NULL)
+				missingKeys.append(key);
+			s->mutex.unlockInline();
 		}
-		this->mutex->unlockInline();
-	}
 
-	void preCache(const QList<Tkey>& keys)
-	{
-		this->mutex->lockInline();
+		if(missingKeys.size() == 0)
+			return;
 
-		if(keys.size() > 0)
-		{
-			Tkey classHolder;	// just to get static _PreCache function
-			QList<Tvalue*> values;
-			// init with null
-			for(int i=0;i<keys.size();i++)
-				values.append(NULL);
+		Tkey classHolder = NULL;	// just to get static _PreCache function
+		QList<Tvalue*> values;
+		// init with null
+		for(int i=0;i<missingKeys.size();i++)
+			values.append(NULL);
 
-			classHolder->_PreCache(keys, values);
+		// no lock held while loading, other threads may add the same keys meanwhile
+		classHolder->_PreCache(missingKeys, values);
 
-			for(int i=0;i<keys.size();i++)
-				if(values[i] != NULL)
-					add(keys[i], values[i]);
+		for(int i=0;i<missingKeys.size();i++)
+		{
+			if(values[i] == NULL)
+				continue;
+
+			Shard* s = this->shardOf(missingKeys[i]);
+			s->mutex.lockInline();
+			if(s->search(missingKeys[i]) == NULL)
+				add(missingKeys[i], values[i]);
+			else
+				delete values[i];
+			s->mutex.unlockInline();
 		}
-		this->mutex->unlockInline();
 	}
 	//!< deletes all nodes, leaves the values untouched (non-deep delete)
 	void Clear()
@@ -90,147 +90,37 @@ DBWorker* DBConnector::worker = NULL;
 
 QSqlDatabase getDatabase() { return QSqlDatabase::database(); }
 
-bool DBConnector::CreateTables()
-{
-	QSqlQuery query;
-
-	if(        query.exec("PRAGMA synchronous=OFF")
-		&& query.exec("PRAGMA count_changes=OFF")
-		// && query.exec("PRAGMA page_size=5120")
-		&& query.exec("PRAGMA journal_mode=OFF")
-		&& query.exec("PRAGMA temp_store=OFF")
-		// && query.exec("PRAGMA cache_size=50000")
-		&& query.exec("CREATE TABLE systems(	uuid BINARY(16) NOT NULL, \
-					  owner BINARY16, \
-					  predecessors TEXT, \
-					  sucessors TEXT, \
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE components(uuid BINARY(16) NOT NULL, \
-					  owner BINARY(16), \
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE nodes(uuid BINARY(16) NOT NULL, \
-					  owner BINARY(16), \
-					  x DOUBLE PRECISION, y DOUBLE PRECISION, z DOUBLE PRECISION, \
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE edges(uuid BINARY(16) NOT NULL, \
-					  owner BINARY(16), \
-					  startnode BINARY(16), \
-					  endnode BINARY(16), \
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE faces(uuid BINARY(16) NOT NULL, \
-					  owner BINARY(16), \
-					  nodes TEXT, \
-					  holes TEXT, \
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE rasterdatas(uuid BINARY(16) NOT NULL, \
-					  owner BINARY(16), \
-					  datalink INT,\
-					  PRIMARY KEY (uuid))")
-		&& query.exec("CREATE TABLE rasterfields(owner BINARY(16) NOT NULL, \
-					  x BIGINT, \
-					  y BIGINT, \
-					  data BYTEA, \
-					  PRIMARY KEY (owner,x,y))")
-		&& query.exec("CREATE TABLE attributes(\
-					  owner BINARY(16) NOT NULL, \
-					  name VARCHAR(128) NOT NULL, \
-					  type SMALLINT, \
-					  value BYTEA, \
-					  PRIMARY KEY (owner, name))")
-					  )
-			return true;
-
-	PrintSqlError(&query);
-	return false;
-}
-
-bool DBConnector::DropTables()
-{
-	QSqlQuery query;
-	if(	query.exec("DROP TABLE IF EXISTS systems")
-		&&	query.exec("DROP TABLE IF EXISTS components")
-		&&	query.exec("DROP TABLE IF EXISTS nodes")
-		&&	query.exec("DROP TABLE IF EXISTS edges")
-		&&	query.exec("DROP TABLE IF EXISTS faces")
-		&&	query.exec("DROP TABLE IF EXISTS rasterdatas")
-		&&	query.exec("DROP TABLE IF EXISTS rasterfields")
-		&&	query.exec("DROP TABLE IF EXISTS attributes")
-		)
-		return true;
-
-	PrintSqlError(&query);
-	return false;
-}
-
-
 DBConnector::DBConnector()
 {
+	worker = NULL;
+	backend = NULL;
+	backendType = SQLITE_FILE;
+
 	DBConnectorConfig cfg;
 	/*cfg.queryStackSize = 100;
 	cfg.cacheBlockwritingSize = 50;
 	cfg.attributeCacheSize = 1e8;
 	cfg.nodeCacheSize = 1e7;*/
 	setConfig(cfg);
+}
 
-	worker = NULL;
+void DBConnector::SetBackend(DBBackendType type)
+{
 #ifdef NO_DB_SYNC
 	return;
 #endif
-
-	QDateTime time = QDateTime::currentDateTime();
-	QString dbpath = QDir::tempPath() + "/dynamind" + time.toString("_yyMMdd_hhmmss_zzz")+".db";
-	std::string str = dbpath.toStdString();
-
-	if(QFile::exists(dbpath))
-		QFile::remove(dbpath);
-	//_db = new QSqlDatabase();
-	QSqlDatabase _db = QSqlDatabase::addDatabase("QSQLITE");
-	//_db.setDatabaseName(":memory:");
-	_db.setDatabaseName(dbpath);
-	/*
-	QString connectionString = "DRIVER={MySQL ODBC 5.2w Driver};SERVER=localhost;DATABASE=dynamind;";
-	QSqlDatabase db = QSqlDatabase::addDatabase("QODBC");
-	db.setDatabaseName(connectionString);
-	db.setUserName("root");
-	db.setPassword("");
-	*/
-	/*
-	QString connectionString = "DRIVER={PostgreSQL Unicode(x64)};SERVER=localhost;DATABASE=dynamind;";
-	QSqlDatabase db = QSqlDatabase::addDatabase("QODBC");
-	db.setDatabaseName(connectionString);
-	db.setUserName("postgres");
-	db.setPassword("");
-	*/
-	/*
-	//QString connectionString = "SERVER=localhost;DATABASE=dynamind;";
-	QSqlDatabase db = QSqlDatabase::addDatabase("QPSQL");
-	db.setDatabaseName("dynamind");
-	db.setUserName("postgres");
-	db.setPassword("");
-	*/
-	if(!_db.open())
+	if(backend)
 	{
-		Logger(Error) << "Failed to open db connection";
-
-		QSqlError e = _db.lastError();
-		Logger(Error) << "driver error: " << e.driverText();
-		Logger(Error) << "database error: " << e.databaseText();
-		return;
+		// pending queries belong to the old database
+		killWorker();
+		backend->Close();
+		delete backend;
 	}
-	else
-		Logger(Debug) << "Db connection opened";
 
-	// init table structure
-	if(!DropTables() || !CreateTables())
-	{
-		Logger(Error) << "Cannot initialize db tables";
-		DropTables();
-		//db.removeDatabase("QODBC");
-		_db.removeDatabase("QSQLITE");
-		_db.close();
-		return;
-	}
-	Logger(Debug) << "DB created";
+	backendType = type;
+	backend = DbBackend::Create(type);
+	if(!backend->Open())
+		Logger(Error) << "Failed to open storage backend";
 
 	initWorker();
 }
@@ -242,71 +132,144 @@ unsigned long readCount = 0;
 unsigned long writesBeforeReadsCount = 0;
 #endif
 
+DBWorker::DBWorker(): QThread(), queryStack(WORKER_QUEUE_SIZE)
+{
+	qSelect = NULL;
+	kill = false;
+	selectStatus = 0;
+}
+
+bool DBWorker::HasWork(QElapsedTimer& pendingWrites, unsigned long& waitTime)
+{
+	waitTime = WORKER_IDLE_TIMEOUT;
+	if(qSelect)
+		return true;
+
+	queryListsLock.lockForRead();
+	for(QHash<QString, QueryList*>::const_iterator it = queryLists.constBegin(); it != queryLists.constEnd(); ++it)
+	{
+		if(it.value()->queryStack.IsMaxOneLeft())
+		{
+			queryListsLock.unlock();
+			return true;
+		}
+	}
+	queryListsLock.unlock();
+
+	if(queryStack.IsEmpty())
+		return false;
+
+	// collect writes till the batch is full or the oldest one waited long enough
+	if(!pendingWrites.isValid())
+		pendingWrites.start();
+
+	DBConnector* db = DBConnector::getInstance();
+	unsigned long age = pendingWrites.elapsed();
+	int size = queryStack.Size();
+	if((unsigned long)size >= db->GetWriteBatchSize() || size >= queryStack.Capacity()
+		|| age >= db->GetWriteBatchLatency())
+		return true;
+
+	waitTime = db->GetWriteBatchLatency() - age;
+	return false;
+}
+
+void DBWorker::SignalWork()
+{
+	waiterMutex.lock();
+	waiterCondition.wakeOne();
+	waiterMutex.unlock();
+}
+
+void DBWorker::SignalDrained()
+{
+	drainedMutex.lock();
+	drainedCondition.wakeAll();
+	drainedMutex.unlock();
+}
+
 void DBWorker::run()
 {
-	std::list<QueryList*>::iterator it;
-	std::list<QueryList*>::iterator end;
-	QueryList* ql;
-	unsigned long curWait = WORKER_SLEEP_TIME_MIN;
+	QList<QueryList*> emptyLists;
 	while(!kill)
 	{
-		end = queryLists.end();
 		unsigned long stackSize = DBConnector::getInstance()->GetQueryStackSize();
-		for(it = queryLists.begin(); it != end; ++it)	// faster then foreach
-		{
-			ql = *it;
+		bool prepared = false;
+		// query lists are only deleted with the worker, so we may prepare without holding the lock
+		emptyLists.clear();
+		queryListsLock.lockForRead();
+		foreach(QueryList* ql, queryLists)
 			if(ql->queryStack.IsMaxOneLeft())
-			{
-				for(int i=1;i<stackSize;i++)
-				{
-					QSqlQuery* q = new QSqlQuery();
-					q->setForwardOnly(true);
-					q->prepare(ql->cmd);
-					ql->queryStack.push(q);
-				}
-			}
-		}
+				emptyLists.append(ql);
+		queryListsLock.unlock();
 
-		// wait loop
-		bool wait = true;
-		while(wait && !kill)
+		foreach(QueryList* ql, emptyLists)
 		{
-			if(!queryStack.IsEmpty() || qSelect)
-			{
-				curWait = WORKER_SLEEP_TIME_MIN;
-				wait = false;
-				break;
-			}
-
-			for(it = queryLists.begin(); it != queryLists.end(); ++it)	// faster then foreach
+			for(unsigned long i=1;i<stackSize;i++)
 			{
-				if((*it)->queryStack.IsMaxOneLeft())
+				QSqlQuery* q = new QSqlQuery();
+				q->setForwardOnly(true);
+				q->prepare(ql->cmd);
+				if(!ql->queryStack.push(q))
 				{
-					curWait = WORKER_SLEEP_TIME_MIN;
-					wait = false;
+					// pool is full, e.g. after the stack size has been increased
+					delete q;
 					break;
 				}
 			}
-			if(wait)
-			{
-				msleep(curWait);
-				curWait = min(curWait*2,(unsigned long)WORKER_SLEEP_TIME_MAX);
-			}
+			prepared = true;
+		}
+		if(prepared)
+		{
+			// wake up clients waiting for a query
+			preparedMutex.lock();
+			preparedCondition.wakeAll();
+			preparedMutex.unlock();
 		}
 
-		//WaitIfNothingToDo();
+		// wait till something is queued, clients signal via SignalWork
+		QElapsedTimer pendingWrites;
+		pendingWrites.invalidate();
+		unsigned long waitTime;
+		waiterMutex.lock();
+		while(!kill && !HasWork(pendingWrites, waitTime))
+			waiterCondition.wait(&waiterMutex, waitTime);
+		waiterMutex.unlock();
+
 #ifdef DBWORKER_COUNTERS
 		loopCount++;
 		unsigned long cnt = 0;
 #endif
-		while(QSqlQuery* q = queryStack.pop())
+		if(!queryStack.IsEmpty())
 		{
+			// execute the writes in transactions of writeBatchSize statements
+			unsigned long batchSize = DBConnector::getInstance()->GetWriteBatchSize();
+			QSqlDatabase db = getDatabase();
+			bool transaction = batchSize > 1 && db.transaction();
+			unsigned long batchCount = 0;
+			while(QSqlQuery* q = queryStack.pop())
+			{
 #ifdef DBWORKER_COUNTERS
-			writeCount++;
-			cnt++;
+				writeCount++;
+				cnt++;
 #endif
-			if(!q->exec())	PrintSqlError(q);
-			delete q;
+				if(!q->exec())	PrintSqlError(q);
+				delete q;
+
+				if(++batchCount >= batchSize)
+				{
+					if(transaction)
+					{
+						if(!db.commit())	PrintSqlErrorE(db.lastError());
+						transaction = db.transaction();
+					}
+					batchCount = 0;
+					SignalDrained();
+				}
+			}
+			if(transaction && !db.commit())
+				PrintSqlErrorE(db.lastError());
+			SignalDrained();
 		}
 		if(qSelect)
 		{
@@ -316,7 +279,14 @@ void DBWorker::run()
 #endif
 			selectMutex.lock();
 			selectRows.clear();
-			if(qSelect->exec() && qSelect->next())
+			if(!qSelect->exec())
+			{
+				PrintSqlError(qSelect);
+				selectStatus = SELECT_FALSE;
+			}
+			else if(!qSelect->next())
+				selectStatus = SELECT_FALSE;	// no results
+			else
 			{
 				int i=0;
 				do
@@ -338,17 +308,12 @@ void DBWorker::run()
 
 				selectStatus = i;
 			}
-			else
-			{
-				PrintSqlError(qSelect);
-				selectStatus = SELECT_FALSE;
-			}
 
-			//selectStatus = (qSelect->exec() && qSelect->next())?SELECT_TRUE:SELECT_FALSE;
 			delete qSelect;
 			qSelect = NULL;
+			// wake up the waiting client
+			selectCondition.wakeAll();
 			selectMutex.unlock();
-			//selectWaiterCondition.wakeOne();
 		}
 	}
 	//exec();
@@ -356,51 +321,74 @@ void DBWorker::run()
 
 void DBWorker::addQuery(QSqlQuery *q)
 {
-	queryStack.push(q);
-	//SignalWork();
+	if(!queryStack.push(q))
+	{
+		// queue is full, wait for the worker to execute a batch
+		drainedMutex.lock();
+		SignalWork();
+		while(!queryStack.push(q))
+			drainedCondition.wait(&drainedMutex, WORKER_IDLE_TIMEOUT);
+		drainedMutex.unlock();
+	}
+	// the worker only needs to know about the first write and a full batch
+	int size = queryStack.Size();
+	if(size == 1 || (unsigned long)size >= DBConnector::getInstance()->GetWriteBatchSize())
+		SignalWork();
 }
 
-bool DBWorker::ExecuteSelect(QSqlQuery *q)
+bool DBWorker::ExecuteSelect(QSqlQuery *q, QList<QList<QVariant> >* rows)
 {
 	clientSelectMutex.lock();
-	selectMutex.lockInline();
+	selectMutex.lock();
 	qSelect = q;
 	selectStatus = SELECT_NOTDONE;
-	selectMutex.unlockInline();
+	SignalWork();
 
-	// wait for finish
+	// wait for finish, the worker signals as soon as the results are available
 	while(selectStatus == SELECT_NOTDONE)
-		usleep(EXE_THREAD_SLEEP_TIME);
+		selectCondition.wait(&selectMutex);
 
+	bool success = selectStatus>0;
+	// the next select of another thread overwrites selectRows
+	if(success)
+		rows->append(selectRows);
+	selectMutex.unlock();
 	clientSelectMutex.unlock();
-	return selectStatus>0;
+	return success;
 }
 
 QSqlQuery* DBWorker::getQuery(QString cmd)
 {
-	QueryList* ql = NULL;
 	// search for query list
-	queryMutex.lockInline();
-	foreach(QueryList* it, queryLists)
+	queryListsLock.lockForRead();
+	QueryList* ql = queryLists.value(cmd, NULL);
+	queryListsLock.unlock();
+	if(!ql)
 	{
-		if(it->cmd == cmd)
+		// no list found, create
+		queryListsLock.lockForWrite();
+		ql = queryLists.value(cmd, NULL);
+		if(!ql)
 		{
-			ql = it;
-			break;
+			ql = new QueryList(cmd, DBConnector::getInstance()->GetQueryStackSize());
+			queryLists[cmd] = ql;
 		}
+		queryListsLock.unlock();
 	}
-	if(!ql)
+
+	QSqlQuery *q = ql->queryStack.pop();
+	if(!q)
 	{
-		// no list found, create
-		ql = new QueryList;
-		ql->cmd = cmd;
-		queryLists.push_back(ql);
+		// wait for the worker to prepare new queries
+		preparedMutex.lock();
+		SignalWork();
+		while(!(q = ql->queryStack.pop()))
+			preparedCondition.wait(&preparedMutex, WORKER_IDLE_TIMEOUT);
+		preparedMutex.unlock();
 	}
-
-	QSqlQuery *q = NULL;
-	while(!(q = ql->queryStack.pop()))
-		usleep(EXE_THREAD_SLEEP_TIME);
-	queryMutex.unlockInline();
+	// let the worker refill the stack in time
+	if(ql->queryStack.IsMaxOneLeft())
+		SignalWork();
 	return q;
 }
 
@@ -410,12 +398,22 @@ DBWorker::~DBWorker()
 	selectMutex.unlock();
 	//getDatabase();
 	foreach(QueryList* it, queryLists)
+	{
+		// prepared queries keep the db connection in use
+		while(QSqlQuery* q = it->queryStack.pop())
+			delete q;
 		delete it;
+	}
 }
 
 DBConnector::~DBConnector()
 {
 	killWorker();
+	if(backend)
+	{
+		backend->Close();
+		delete backend;
+	}
 }
 
 void DBConnector::killWorker()
@@ -454,6 +452,11 @@ DBConnectorConfig DBConnector::getConfig()
 //	cfg.attributeCacheSize = Attribute::GetCacheSize();
 	cfg.cacheBlockwritingSize = cacheBlockwritingSize;
 	cfg.queryStackSize = queryStackSize;
+	cfg.writeBatchSize = writeBatchSize;
+	cfg.writeBatchLatency = writeBatchLatency;
+	cfg.backend = backendType;
+	cfg.cachePolicy = cachePolicy;
+	cfg.cacheMemoryBudget = CacheBudget::GetLimit();
 	return cfg;
 }
 void DBConnector::setConfig(DBConnectorConfig cfg)
@@ -472,6 +475,22 @@ void DBConnector::setConfig(DBConnectorConfig cfg)
 		Logger(Error) << "invalid value: query stack size cannot be <1";
 	else
 		this->queryStackSize = cfg.queryStackSize;
+
+	if(cfg.writeBatchSize<1)
+		Logger(Error) << "invalid value: write batch size cannot be <1";
+	else
+		this->writeBatchSize = cfg.writeBatchSize;
+
+	this->writeBatchLatency = cfg.writeBatchLatency;
+	this->cachePolicy = cfg.cachePolicy;
+
+	if(cfg.cacheMemoryBudget<0)
+		Logger(Error) << "invalid value: cache memory budget cannot be <0";
+	else
+		CacheBudget::SetLimit(cfg.cacheMemoryBudget);
+
+	if(!backend || cfg.backend != backendType)
+		SetBackend(cfg.backend);
 }
 
 QSqlQuery* DBConnector::getQuery(QString cmd)
@@ -487,14 +506,9 @@ void DBConnector::ExecuteQuery(QSqlQuery *q)
 	worker->addQuery(q);
 }
 
-bool DBConnector::ExecuteSelectQuery(QSqlQuery *q)
+bool DBConnector::ExecuteSelectQuery(QSqlQuery *q, QList<QList<QVariant> >* rows)
 {
-	return worker->ExecuteSelect(q);
-}
-
-QList<QList<QVariant> >* DBConnector::getResults()
-{
-	return &worker->selectRows;
+	return worker->ExecuteSelect(q, rows);
 }
 
 void DBConnector::Synchronize()
@@ -515,6 +529,8 @@ void DBConnector::Insert(QString table, QUuid uuid)
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("INSERT INTO "+table+" (uuid) VALUES (?)");
 	q->addBindValue(uuid.toByteArray());
@@ -526,6 +542,8 @@ void DBConnector::Insert(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("INSERT INTO "+table+" (uuid,"+
 		parName0+") VALUES (?,?)");
@@ -540,6 +558,8 @@ void DBConnector::Insert(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("INSERT INTO "+table+" (uuid,"+
 		parName0+","+
@@ -557,6 +577,8 @@ void DBConnector::Insert(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("INSERT INTO "+table+" (uuid,"+
 		parName0+","+
@@ -576,6 +598,8 @@ void DBConnector::Insert(QString table,  QUuid owner, QString name,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 	
 	QString query = "INSERT INTO " + table + "(owner,name";
 	if(parValue0) query += "," + parName0;
@@ -603,6 +627,8 @@ void DBConnector::Delete(QString table,  QUuid uuid)
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("DELETE FROM "+table+" WHERE uuid LIKE ?");
 	q->addBindValue(uuid.toByteArray());
@@ -613,6 +639,8 @@ void DBConnector::Delete(QString table,  QUuid owner, QString name)
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("DELETE FROM "+table+" WHERE owner LIKE ? AND name LIKE ?");
 	q->addBindValue(owner.toByteArray());
@@ -628,6 +656,8 @@ void DBConnector::Update(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("UPDATE "+table+" SET "+parName0+"=? WHERE uuid LIKE ?");
 	q->addBindValue(parValue0);
@@ -642,6 +672,8 @@ void DBConnector::Update(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("UPDATE "+table+" SET "
 		+parName0+"=?,"
@@ -659,6 +691,8 @@ void DBConnector::Update(QString table,  QUuid uuid,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 
 	QSqlQuery *q = getQuery("UPDATE "+table+" SET "
 		+parName0+"=?,"
@@ -679,6 +713,8 @@ void DBConnector::Update(QString table,  QUuid owner, QString name,
 #ifdef NO_DB_SYNC
 	return;
 #endif
+	if(!backend->IsSql())
+		return;
 	QString query = "UPDATE "+table+" SET ";
 	if(parValue0) query += parName0 + "=?";
 	if(parValue1) query += "," + parName1 + "=?";
@@ -702,14 +738,17 @@ bool DBConnector::Select(QString table, QUuid uuid,
 #ifdef NO_DB_SYNC
 	return false;
 #endif
+	if(!backend->IsSql())
+		return false;
 
 	QSqlQuery *q = getQuery("SELECT "+valName+" FROM "+table+" WHERE uuid LIKE ?");
 	q->addBindValue(uuid.toByteArray());
 
-	if(!ExecuteSelectQuery(q))
+	QList<QList<QVariant> > rows;
+	if(!ExecuteSelectQuery(q, &rows))
 		return false;
 
-	*value = getResults()->at(0).at(0);
+	*value = rows.at(0).at(0);
 
 	return true;
 }
@@ -720,14 +759,17 @@ bool DBConnector::Select(QString table, QUuid uuid,
 #ifdef NO_DB_SYNC
 	return false;
 #endif
+	if(!backend->IsSql())
+		return false;
 
 	QSqlQuery *q = getQuery("SELECT "+valName0+","+valName1+" FROM "+table+" WHERE uuid LIKE ?");
 	q->addBindValue(uuid.toByteArray());
-	if(!ExecuteSelectQuery(q))
+	QList<QList<QVariant> > rows;
+	if(!ExecuteSelectQuery(q, &rows))
 		return false;
 
-	*value0 = getResults()->at(0).at(0);
-	*value1 = getResults()->at(0).at(1);
+	*value0 = rows.at(0).at(0);
+	*value1 = rows.at(0).at(1);
 
 	return true;
 }
@@ -739,15 +781,18 @@ bool DBConnector::Select(QString table, QUuid uuid,
 #ifdef NO_DB_SYNC
 	return false;
 #endif
+	if(!backend->IsSql())
+		return false;
 
 	QSqlQuery *q = getQuery("SELECT "+valName0+","+valName1+","+valName2+" FROM "+table+" WHERE uuid LIKE ?");
 	q->addBindValue(uuid.toByteArray());
-	if(!ExecuteSelectQuery(q))
+	QList<QList<QVariant> > rows;
+	if(!ExecuteSelectQuery(q, &rows))
 		return false;
 
-	*value0 = getResults()->at(0).at(0);
-	*value1 = getResults()->at(0).at(1);
-	*value2 = getResults()->at(0).at(2);
+	*value0 = rows.at(0).at(0);
+	*value1 = rows.at(0).at(1);
+	*value2 = rows.at(0).at(2);
 	return true;
 }
 
@@ -759,6 +804,8 @@ bool DBConnector::Select(QString table, QUuid owner, QString name,
 #ifdef NO_DB_SYNC
 	return false;
 #endif
+	if(!backend->IsSql())
+		return false;
 	QString query = "SELECT ";
 	if(value0) query += valName0;
 	if(value1) query += "," + valName1;
@@ -768,13 +815,14 @@ bool DBConnector::Select(QString table, QUuid owner, QString name,
 	QSqlQuery *q = getQuery(query);
 	q->addBindValue(owner.toByteArray());
 	q->addBindValue(name);
-	if(!ExecuteSelectQuery(q))
+	QList<QList<QVariant> > rows;
+	if(!ExecuteSelectQuery(q, &rows))
 		return false;
 
 	int i=0;
-	if(value0 != NULL)	*value0 = getResults()->at(0).at(i++);
-	if(value1 != NULL)	*value1 = getResults()->at(0).at(i++);
-	if(value2 != NULL)	*value2 = getResults()->at(0).at(i);
+	if(value0 != NULL)	*value0 = rows.at(0).at(i++);
+	if(value1 != NULL)	*value1 = rows.at(0).at(i++);
+	if(value2 != NULL)	*value2 = rows.at(0).at(i);
 	return true;
 }
 
@@ -783,30 +831,17 @@ bool DBConnector::Select(QString table, const QList<QUuid*>& uuids, QList<QUuid>
 						 QString valName1, QList<QVariant> *value1,
 						 QString valName2, QList<QVariant> *value2)
 {
-#ifdef NO_DB_SYNC
-	return false;
-#endif
-	if(uuids.size() == 0)
-		return false;
-
-	QString queryString = "SELECT uuid,"+valName0+","+valName1+","+valName2+" FROM "+table+" WHERE uuid LIKE ?";
-
-	for(int i=1;i<uuids.size(); i++)
-		queryString.append(" OR uuid LIKE ?");
-
-	QSqlQuery *q = getQuery(queryString);
-
+	QList<QVariant> keys;
 	foreach(QUuid* uuid, uuids)
-		q->addBindValue(uuid->toByteArray());
+		keys.append(uuid->toByteArray());
 
-	if(!ExecuteSelectQuery(q))
+	QList<QList<QVariant> > rows;
+	if(!SelectIn(table, "uuid", keys, valName0+","+valName1+","+valName2, &rows))
 		return false;
 
-	QList<QList<QVariant> >* results = getResults();
-
-	foreach(QList<QVariant> row, *results)
+	foreach(const QList<QVariant>& row, rows)
 	{
-		resultUuids->append(row.at(0).toByteArray());
+		resultUuids->append(QUuid(row.at(0).toByteArray()));
 
 		value0->append(row.at(1));
 		value1->append(row.at(2));
@@ -815,3 +850,42 @@ bool DBConnector::Select(QString table, const QList<QUuid*>& uuids, QList<QUuid>
 
 	return true;
 }
+
+bool DBConnector::SelectIn(QString table, QString keyName, const QList<QVariant>& keys,
+						   QString valNames, QList<QList<QVariant> >* rows,
+						   QString condition, const QList<QVariant>& conditionValues)
+{
+#ifdef NO_DB_SYNC
+	return false;
+#endif
+	if(!backend->IsSql())
+		return false;
+	if(keys.size() == 0)
+		return false;
+
+	// all blocks have the same size, so only one query has to be prepared
+	const int blockSize = SQLBLOCKQUERYSIZE - conditionValues.size();
+
+	QString queryString = "SELECT "+keyName+","+valNames+" FROM "+table+" WHERE ";
+	if(condition.size())
+		queryString += condition+" AND ";
+	queryString += keyName+" IN (?";
+	for(int i=1;i<blockSize;i++)
+		queryString += ",?";
+	queryString += ")";
+
+	bool found = false;
+	for(int block=0;block<keys.size();block+=blockSize)
+	{
+		QSqlQuery *q = getQuery(queryString);
+		foreach(const QVariant& value, conditionValues)
+			q->addBindValue(value);
+		// the last block is filled up by repeating the last key
+		for(int i=block;i<block+blockSize;i++)
+			q->addBindValue(keys.at(qMin(i, keys.size()-1)));
+
+		if(ExecuteSelectQuery(q, rows))
+			found = true;
+	}
+	return found;
+}
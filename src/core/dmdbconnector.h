@@ -31,8 +31,14 @@
 #include <queue>
 #include <qatomic.h>
 #include "dmcache.h"
+#include "dmdbbackend.h"
 #include <qvariant.h>
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QElapsedTimer>
 #include <QUuid>
 #include <QString>
 
@@ -56,83 +62,128 @@ public:
 	}
 };
 
+/**************************************************************//**
+@class DM::FIFOQueue
+@ingroup DynaMind-Core
+@brief
+A bounded lock-free queue for multiple producers and consumers.
+Used as multi producer single consumer queue for the write queries
+and as single producer multi consumer pool for prepared queries.
+
+COMMENTS
+Each cell carries a sequence number, telling producers and consumers
+whether the cell is free for the lap they are in. The capacity is
+rounded up to the next power of two. push returns false if the queue
+is full, pop returns NULL if it is empty.
+
+******************************************************************/
 template<typename T>
 class FIFOQueue
 {
-	class Node
+	struct Cell
 	{
-	public:
-		Node(T* data)
-		{
-			next = NULL;
-			pData = data;
-		}
-		Node* next;
+		QAtomicInt sequence;
 		T*	pData;
 	};
-	Node* root;
-	Node* last;
-	QMutex m;
-	QAtomicInt isEmpty;
-	QAtomicInt maxOneLeft;
+	Cell*	cells;
+	int		mask;
+	QAtomicInt enqueuePos;
+	QAtomicInt dequeuePos;
+
+	FIFOQueue(const FIFOQueue&);
+	FIFOQueue& operator=(const FIFOQueue&);
 public:
-	FIFOQueue()
+	FIFOQueue(unsigned long capacity)
+	{
+		int size = 2;
+		while((unsigned long)size < capacity)
+			size <<= 1;
+
+		cells = new Cell[size];
+		for(int i=0;i<size;i++)
+		{
+			cells[i].sequence = i;
+			cells[i].pData = NULL;
+		}
+		mask = size-1;
+		enqueuePos = 0;
+		dequeuePos = 0;
+	}
+	~FIFOQueue()
 	{
-		root = NULL;
-		last = NULL;
-		isEmpty = true;
-		maxOneLeft = true;
+		delete[] cells;
 	}
-	~FIFOQueue(){}
 	T* pop()
 	{
-		if(isEmpty)
-			return NULL;
-
-		m.lock();
-		Node* n = root;
-		T* d = root->pData;
-
-		if(root == last)
+		Cell* cell;
+		int pos = dequeuePos;
+		for(;;)
 		{
-			isEmpty = true;
-			maxOneLeft = true;
-			last = NULL;
+			cell = &cells[pos & mask];
+			int diff = (int)((unsigned int)cell->sequence - ((unsigned int)pos+1));
+			if(diff == 0)
+			{
+				if(dequeuePos.testAndSetOrdered(pos, (int)((unsigned int)pos+1)))
+					break;
+				pos = dequeuePos;
+			}
+			else if(diff < 0)
+				return NULL;	// empty
+			else
+				pos = dequeuePos;
 		}
-		else if(root->next == last)
-			maxOneLeft = true;
-
-		root = n->next;
-		delete n;
-		m.unlock();
+		T* d = cell->pData;
+		// free the cell for the next lap of the producers
+		cell->sequence.fetchAndStoreRelease((int)((unsigned int)pos+mask+1));
 		return d;
 	}
-	void push(T* data)
+	bool push(T* data)
 	{
-		m.lock();
-		if(isEmpty)
-			root = last = new Node(data);
-		else
+		Cell* cell;
+		int pos = enqueuePos;
+		for(;;)
 		{
-			last->next = new Node(data);
-			last = last->next;
-			maxOneLeft = false;
+			cell = &cells[pos & mask];
+			int diff = (int)((unsigned int)cell->sequence - (unsigned int)pos);
+			if(diff == 0)
+			{
+				if(enqueuePos.testAndSetOrdered(pos, (int)((unsigned int)pos+1)))
+					break;
+				pos = enqueuePos;
+			}
+			else if(diff < 0)
+				return false;	// full
+			else
+				pos = enqueuePos;
 		}
-		isEmpty = false;
-		m.unlock();
+		cell->pData = data;
+		// publish the data to the consumers
+		cell->sequence.fetchAndStoreRelease((int)((unsigned int)pos+1));
+		return true;
+	}
+	//!< number of queued elements, may be outdated as soon as it is returned
+	inline int Size()
+	{
+		int size = (int)((unsigned int)enqueuePos - (unsigned int)dequeuePos);
+		return size < 0 ? 0 : size;
+	}
+	inline int Capacity()
+	{
+		return mask+1;
 	}
 	inline bool IsEmpty()
 	{
-		return isEmpty;
+		return Size() == 0;
 	}
 	inline bool IsMaxOneLeft()
 	{
-		return maxOneLeft;
+		return Size() <= 1;
 	}
 };
 
 struct QueryList
 {
+	QueryList(QString cmd, unsigned long stackSize): cmd(cmd), queryStack(stackSize){}
 	QString cmd;
 	FIFOQueue<QSqlQuery> queryStack;
 };
@@ -152,7 +203,8 @@ COMMENTS
 class DBWorker: public QThread
 {
 private:
-	QMutex queryMutex;
+	// guards queryLists, lookups only need a read lock
+	QReadWriteLock queryListsLock;
 
 	// flag for leaving run() loop
 	bool	kill;
@@ -164,18 +216,35 @@ private:
 	// returns the value (synchronized read)
 	QMutex	selectMutex;
 	QMutex	clientSelectMutex;
+	// signaled by the worker as soon as the select is done
+	QWaitCondition selectCondition;
 
 	// single select query
 	QSqlQuery *qSelect;
 
-	// list of write queries
-	std::list<QueryList*> queryLists;
-
+	// pools of prepared queries per command
+	QHash<QString, QueryList*> queryLists;
 
 	// to prevent the thread from blocking ressources, a waiter
 	// ensures the thread to sleep while no operations are queued
-	//QMutex waiterMutex;
-	//QWaitCondition waiterCondition;
+	QMutex waiterMutex;
+	QWaitCondition waiterCondition;
+
+	// signaled by the worker as soon as new prepared queries are available
+	QMutex preparedMutex;
+	QWaitCondition preparedCondition;
+
+	// signaled by the worker after executing a batch of writes, clients wait on a full queue
+	QMutex drainedMutex;
+	QWaitCondition drainedCondition;
+
+	// returns true if there are queries to execute or to prepare,
+	// write queries are collected until the batch size or latency is reached
+	bool HasWork(QElapsedTimer& pendingWrites, unsigned long& waitTime);
+	// wakes up the worker
+	void SignalWork();
+	// wakes up clients waiting for space in the write queue
+	void SignalDrained();
 
 	// infinite loop to process queries
 	// workflow: prepare-sleep if nothing to do-write-read
@@ -184,30 +253,26 @@ private:
 	// data updates
 	void run();
 public:
-	DBWorker(): QThread()
-	{
-		qSelect = NULL;
-		kill = false;
-		selectStatus = 0;
-	}
+	DBWorker();
 	~DBWorker();
 
 #define SELECT_NOTDONE 0
 //#define SELECT_TRUE 1
 #define SELECT_FALSE -1
 	QAtomicInt selectStatus;
-    QList< QList<QVariant> >	selectRows;
+    QList< QList<QVariant> >	selectRows;	// only valid while selectMutex is held
 
-	//!< add a new query to the write list (asynchron)
+	//!< add a new query to the write list (asynchron), only blocks if the write queue is full
 	void addQuery(QSqlQuery *q);
-	//!< execute a select query (synchron)
-	bool ExecuteSelect(QSqlQuery* q);
+	//!< execute a select query (synchron), appends the result rows to rows
+	bool ExecuteSelect(QSqlQuery* q, QList<QList<QVariant> >* rows);
 	//!< forces the loop to break up
 	void Kill()
 	{
 		kill = true;
+		SignalWork();
 	}
-	//!< receive a prepared query for execution
+	//!< receive a prepared query for execution, only blocks if the pool of this command is exhausted
 	QSqlQuery *getQuery(QString cmd);
 };
 
@@ -231,15 +296,13 @@ public:
 // greatly improves performance
 //#define NO_DB_SYNC
 
-// time in milliseconds to wait, if worker is idle. starts with min, doubles
-// at each idle loop tick.
-// recommendation 1,128
-#define WORKER_SLEEP_TIME_MIN 1
-#define WORKER_SLEEP_TIME_MAX 64
+// time in milliseconds the worker sleeps at most, if it is idle.
+// the worker gets woken up as soon as queries are queued, this is only a safety net
+#define WORKER_IDLE_TIMEOUT 64
 
-// timeinterval in microseconds to wait for finished select states and new queries
-// recommendation 1us
-#define EXE_THREAD_SLEEP_TIME 1
+// maximum number of write queries queued for the worker, rounded up to a power of two.
+// clients adding queries to a full queue wait for the worker to catch up
+#define WORKER_QUEUE_SIZE 65536
 
 // when e.g. precaching or sleecting large junks of data via uuids, we may exceed 
 // the parameter count limit. 100 seems to work fine in all db products.
@@ -257,6 +320,13 @@ ensures a working db connector. The constructor default values
 are also applied in the DBConnector constructor.
 queryStackSize and cacheBlockwritingSize may not be smaller then 1.
 cacheBlockwritingSize may not be smaller than any cache size-1.
+writeBatchSize may not be smaller then 1. Pending writes are always
+flushed before a select is executed, so batching never delays reads.
+The backend should be chosen before any data is moved out of memory,
+the component tables are only written on sql backends.
+The cache policy applies to caches created afterwards.
+The cache memory budget is shared by all caches and rounded down to
+kilobytes; caches above it shrink as soon as they add elements.
 
 ******************************************************************/
 class DBConnectorConfig
@@ -270,6 +340,16 @@ public:
 	unsigned long attributeCacheSize;
 	//!< size of the node cache, values over 1e7 recommended; 0 enables an infinite cache
 	//unsigned long nodeCacheSize;
+	//!< maximum number of write queries executed in one transaction; 1 disables transactions
+	unsigned long writeBatchSize;
+	//!< time in milliseconds write queries may be held back to fill a batch
+	unsigned long writeBatchLatency;
+	//!< storage for data moved out of memory, changing it discards all stored data
+	DBBackendType backend;
+	//!< eviction policy of the db caches, e.g. raster block caches
+	CachePolicy cachePolicy;
+	//!< memory limit of all caches together in bytes, e.g. raster blocks; 0 disables it
+	qint64 cacheMemoryBudget;
 
 	DBConnectorConfig()
 	{
@@ -277,6 +357,11 @@ public:
 		cacheBlockwritingSize = 50;
 		attributeCacheSize = 0;
 		//nodeCacheSize = 0;
+		writeBatchSize = 10000;
+		writeBatchLatency = 20;
+		backend = SQLITE_FILE;
+		cachePolicy = CACHE_LRU;
+		cacheMemoryBudget = 0;
 	}
 };
 
@@ -295,7 +380,7 @@ INTERNAL WORKFLOW
 q = getQuery(string cmd)
 q->addBindValue(param)
 ...
-ExecuteQuery(q)/ExecuteSelectQuery(q);
+ExecuteQuery(q)/ExecuteSelectQuery(q, &rows);
 ******************************************************************/
 class SingletonDestroyer;
 class DM_HELPER_DLL_EXPORT DBConnector
@@ -312,14 +397,19 @@ private:
 	// worker thread
 	static DBWorker* worker;
 
-	// internal init functions
-	bool CreateTables();
-	bool DropTables();
+	// storage of data moved out of memory
+	DbBackend* backend;
+	DBBackendType backendType;
+	// closes the current backend and opens a new one of the given type
+	void SetBackend(DBBackendType type);
 
 	// settings
 	bool noDBSync;
 	unsigned long queryStackSize;
 	unsigned long cacheBlockwritingSize;
+	unsigned long writeBatchSize;
+	unsigned long writeBatchLatency;
+	CachePolicy cachePolicy;
 
 	static void initWorker();
 protected:
@@ -335,14 +425,20 @@ public:
 	unsigned long  GetQueryStackSize()			{return queryStackSize;}
 	//!< accessor to cache block writing size, refer to DBConnectorConfig
 	unsigned long  GetCacheBlockwritingSize()	{return cacheBlockwritingSize;}
+	//!< accessor to the write batch size, refer to DBConnectorConfig
+	unsigned long  GetWriteBatchSize()			{return writeBatchSize;}
+	//!< accessor to the write batch latency, refer to DBConnectorConfig
+	unsigned long  GetWriteBatchLatency()		{return writeBatchLatency;}
+	//!< accessor to the cache eviction policy, refer to DBConnectorConfig
+	CachePolicy    GetCachePolicy()				{return cachePolicy;}
+	//!< accessor to the storage backend, refer to DBConnectorConfig
+	DbBackend*     getBackend()					{return backend;}
 	//!< get a already prepared query. prepare parameters and send back via Execute(Select)Query
 	QSqlQuery *getQuery(QString cmd);
 	//!< enqueues a WRITE query (asynchron)
 	void ExecuteQuery(QSqlQuery *q);
-	//!< executes a select query, the value can be accessed via QSqlQuery::value(#)
-	bool ExecuteSelectQuery(QSqlQuery *q);
-
-	QList<QList<QVariant> >* getResults();
+	//!< executes a select query and appends the result rows to rows, returns false if there are none
+	bool ExecuteSelectQuery(QSqlQuery *q, QList<QList<QVariant> >* rows);
 	void killWorker();
 
 	//!< synchronizes ALL classes with inherited asynchron class
@@ -403,6 +499,12 @@ public:
 		QString valName0, QList<QVariant> *value0,
 		QString valName1, QList<QVariant> *value1,
 		QString valName2, QList<QVariant> *value2);
+	//!< bulk select of all rows whose key column matches one of the keys. keys are queried in blocks of
+	//!< SQLBLOCKQUERYSIZE, each result row starts with the key followed by the columns in valNames (comma separated).
+	//!< an optional condition, e.g. "name=?", restricts the rows, its parameters are given via conditionValues
+	bool SelectIn(QString table, QString keyName, const QList<QVariant>& keys,
+		QString valNames, QList<QList<QVariant> >* rows,
+		QString condition = "", const QList<QVariant>& conditionValues = QList<QVariant>());
 };
 
 /**************************************************************//**
@@ -29,6 +29,7 @@
 #include "dmface.h"
 #include "dmrasterdata.h"
 #include "dmdataviewer.h"
+#include <algorithm>
 
 using namespace DM;
 
@@ -41,6 +42,7 @@ DerivedSystem::DerivedSystem(System* sys): System()
 	allNodesLoaded = false;
 	allSubSystemsLoaded = false;
 	//allRasterDataLoaded = false;
+	copyCount = 0;
 
 	
 
@@ -69,34 +71,48 @@ Component* DerivedSystem::SuccessorCopy(const Component *src)
 {
 	Component *c = new Component;
 	c->CopyFrom(*src, true);
-	return addComponent(c);
+	copyCount++;
+	return RegisterCopy(src, addComponent(c));
 }
 Node* DerivedSystem::SuccessorCopy(const Node *src)
 {
 	Node* n = new Node();
 	*n = *src;
 	n->CopyFrom(*src, true);
-	return addNode(n);
+	n->ShareCoordinates(src, &nodeStore);
+	copyCount++;
+	return (Node*)RegisterCopy(src, addNode(n));
 }
 Edge* DerivedSystem::SuccessorCopy(const Edge *src)
 {
-	Edge* e = new Edge(getNode(src->getStartpointName()), getNode(src->getEndpointName()));
+	Edge* e = new Edge((Node*)getComponentByName(src->getStartNode()->getNameUUID()),
+		(Node*)getComponentByName(src->getEndNode()->getNameUUID()));
 	e->CopyFrom(*src, true);
-	return addEdge(e);
+	copyCount++;
+	return (Edge*)RegisterCopy(src, addEdge(e));
 }
 Face* DerivedSystem::SuccessorCopy(const Face *src)
 {
 	std::vector<Node*> newNodes;
 	foreach(Node* node, src->getNodePointers())
-		newNodes.push_back(getNode(node->getUUID()));
+		newNodes.push_back((Node*)getComponentByName(node->getNameUUID()));
 
 	Face* newf = new Face(newNodes);
 	newf->CopyFrom(*src,true);
+	copyCount++;
 
 	foreach(Face *hole, src->getHolePointers())
-		newf->addHole(getFace(hole->getUUID()));
+		newf->addHole((Face*)getComponentByName(hole->getNameUUID()));
 
-	return addFace(newf);
+	return (Face*)RegisterCopy(src, addFace(newf));
+}
+
+Component* DerivedSystem::RegisterCopy(const Component *src, Component *copy)
+{
+	if(copy)
+		mforeach(DataViewer* viewer, dataViewers)
+			viewer->registerCopy(src, copy);
+	return copy;
 }
 
 Component* DerivedSystem::SuccessorCopyTypesafe(const Component *src)
@@ -121,26 +137,35 @@ Component* DerivedSystem::SuccessorCopyTypesafe(const Component *src)
 
 const Component* DerivedSystem::getComponentReadOnly(std::string uuid) const
 {
-	if(const Component* n = System::getComponentReadOnly(uuid))
+	return getComponentReadOnlyByName(QUuid(QString::fromStdString(uuid)));
+}
+const Component* DerivedSystem::getComponentReadOnlyByName(const QUuid& name) const
+{
+	if(const Component* n = System::getComponentReadOnlyByName(name))
 		return n;
 
-	return predecessorSys->getComponentReadOnly(uuid);
+	return predecessorSys ? predecessorSys->getComponentReadOnlyByName(name) : NULL;
 }
 const Edge* DerivedSystem::getEdgeReadOnly(Node* start, Node* end)
 {
 	if(const Edge* e = System::getEdgeReadOnly(start,end))
 		return e;
 
-	return predecessorSys->getEdgeReadOnly(start,end);
+	return predecessorSys ? predecessorSys->getEdgeReadOnly(start,end) : NULL;
 }
 
 Component* DerivedSystem::getComponent(std::string uuid)
 {
-	Component* n = System::getComponent(uuid);
-	if(!n)
+	return getComponentByName(QUuid(QString::fromStdString(uuid)));
+}
+
+Component* DerivedSystem::getComponentByName(const QUuid& name)
+{
+	Component* n = System::getComponentByName(name);
+	if(!n && predecessorSys)
 	{
 		QMutexLocker ml(mutex);
-		const Component *nconst = predecessorSys->getComponentReadOnly(uuid);
+		const Component *nconst = predecessorSys->getComponentReadOnlyByName(name);
 		if(nconst)
 		{
 			switch(nconst->getType())
@@ -179,6 +204,7 @@ Edge* DerivedSystem::getEdge(Node* start, Node* end)
 {
 	if(Edge* e = System::getEdge(start,end))
 		return e;
+	if(predecessorSys)
 	{
 		QMutexLocker ml(mutex);
 		const Edge *e = predecessorSys->getEdgeReadOnly(start,end);
@@ -192,18 +218,59 @@ Face * DerivedSystem::getFace(std::string uuid)
 {
 	return (Face*)getComponent(uuid);
 }
-std::map<std::string, Component*> DerivedSystem::getAllComponents()
+// copies all components of the given type of the predecessor states into this system,
+// the predecessors are walked by name, without the string uuids of getAll*
+void DerivedSystem::LoadChilds(Components type)
 {
-	if(!allComponentsLoaded)
-	{
-		QMutexLocker ml(mutex);
+	System::LoadChilds(type);
 
-		// load all components
-		std::map<std::string, Component*> comps = predecessorSys->getAllComponents();
-		mforeach(Component* c, comps)
-			getComponent(c->getUUID());
-		allComponentsLoaded = true;
+	QMutexLocker ml(mutex);
+	switch(type)
+	{
+	case COMPONENT:
+		if(!allComponentsLoaded)
+		{
+			predecessorSys->LoadChilds(COMPONENT);
+			foreach(Component* c, predecessorSys->components)
+				getComponentByName(c->getNameUUID());
+			allComponentsLoaded = true;
+		}
+		break;
+	case NODE:
+		if(!allNodesLoaded)
+		{
+			predecessorSys->LoadChilds(NODE);
+			foreach(Node* n, predecessorSys->nodes)
+				getComponentByName(n->getNameUUID());
+			allNodesLoaded = true;
+		}
+		break;
+	case EDGE:
+		if(!allEdgesLoaded)
+		{
+			predecessorSys->LoadChilds(EDGE);
+			foreach(Edge* e, predecessorSys->edges)
+				getComponentByName(e->getNameUUID());
+			allEdgesLoaded = true;
+		}
+		break;
+	case FACE:
+		if(!allFacesLoaded)
+		{
+			predecessorSys->LoadChilds(FACE);
+			foreach(Face* f, predecessorSys->faces)
+				getComponentByName(f->getNameUUID());
+			allFacesLoaded = true;
+		}
+		break;
+	default:
+		break;
 	}
+}
+
+std::map<std::string, Component*> DerivedSystem::getAllComponents()
+{
+	LoadChilds(COMPONENT);
 	return System::getAllComponents();
 }
 /*
@@ -231,44 +298,17 @@ std::map<std::string, Component*> DerivedSystem::getAllComponentsInView(const DM
 }*/
 std::map<std::string, Node*> DerivedSystem::getAllNodes()
 {
-	if(!allNodesLoaded)
-	{
-		QMutexLocker ml(mutex);
-
-		// load all nodes
-		std::map<std::string, Node*> nodes = predecessorSys->getAllNodes();
-		mforeach(Node* n, nodes)
-			getNode(n->getUUID());
-		allNodesLoaded = true;
-	}
+	LoadChilds(NODE);
 	return System::getAllNodes();
 }
 std::map<std::string, Edge*> DerivedSystem::getAllEdges()
 {
-	if(!allEdgesLoaded)
-	{
-		QMutexLocker ml(mutex);
-
-		// load all nodes
-		std::map<std::string, Edge*> edges = predecessorSys->getAllEdges();
-		mforeach(Edge* n, edges)
-			getEdge(n->getUUID());
-		allEdgesLoaded = true;
-	}
+	LoadChilds(EDGE);
 	return System::getAllEdges();
 }
 std::map<std::string, Face*> DerivedSystem::getAllFaces()
 {
-	if(!allFacesLoaded)
-	{
-		QMutexLocker ml(mutex);
-
-		// load all nodes
-		std::map<std::string, Face*> faces = predecessorSys->getAllFaces();
-		mforeach(Face* n, faces)
-			getFace(n->getUUID());
-		allFacesLoaded = true;
-	}
+	LoadChilds(FACE);
 	return System::getAllFaces();
 }
 std::map<std::string, System*> DerivedSystem::getAllSubSystems()
@@ -280,7 +320,7 @@ std::map<std::string, System*> DerivedSystem::getAllSubSystems()
 		// load all nodes
 		std::map<std::string, System*> subsystems = predecessorSys->getAllSubSystems();
 		mforeach(System* sys, subsystems)
-			getSubSystem(sys->getUUID());
+			getChildByName(sys->getNameUUID());
 		allSubSystemsLoaded = true;
 	}
 	return System::getAllSubSystems();
@@ -288,6 +328,9 @@ std::map<std::string, System*> DerivedSystem::getAllSubSystems()
 
 std::map<std::string, RasterData*> DerivedSystem::getAllRasterData()
 {
+	if(!predecessorSys)
+		return System::getAllRasterData();
+
 	std::map<std::string, RasterData*> pred_rd = this->predecessorSys->getAllRasterData();
 	std::map<std::string, RasterData*> rd = System::getAllRasterData();
 
@@ -299,3 +342,77 @@ std::map<std::string, RasterData*> DerivedSystem::getAllRasterData()
 
 	return pred_rd;
 }
+
+unsigned int DerivedSystem::getDepth() const
+{
+	unsigned int depth = 0;
+	for(const DerivedSystem* sys = this; sys && sys->predecessorSys;
+		sys = dynamic_cast<const DerivedSystem*>(sys->predecessorSys))
+		depth++;
+	return depth;
+}
+
+bool DerivedSystem::Flatten()
+{
+	if(!predecessorSys)
+		return true;
+
+	QMutexLocker ml(mutex);
+
+	// successors may still read components of the predecessors
+	if(sucessors.size())
+		return false;
+
+	std::vector<System*> chain;
+	for(System* sys = predecessorSys; sys; sys = sys->predecessors.size() ? sys->predecessors[0] : NULL)
+	{
+		// subsystems aren't copied into successor states
+		if(sys->subsystems.size())
+			return false;
+		chain.push_back(sys);
+	}
+
+	// copy the newest version of every component, walking the chain directly instead of
+	// loading all components into each predecessor as LoadChilds does
+	foreach(System* sys, chain)
+	{
+		sys->System::LoadChilds(NODE);
+		foreach(Component* c, sys->ownedchilds)
+		{
+			if(c->getType() != RASTERDATA)
+				getComponentByName(c->getNameUUID());
+			else if(!System::getComponentByName(c->getNameUUID()))
+				// raster data is shared by all states, a flattened state gets its own copy
+				addRasterData(new RasterData(*(RasterData*)c));
+		}
+	}
+	allComponentsLoaded = allNodesLoaded = allEdgesLoaded = allFacesLoaded = allSubSystemsLoaded = true;
+
+	// take over everything still shared with the predecessors
+	CloneAllAttributes();
+	foreach(Component* c, ownedchilds)
+	{
+		c->CloneAllAttributes();
+		if(c->getType() == NODE)
+		{
+			Node* n = (Node*)c;
+			if(n->SharesBlock())
+				n->Unshare();
+			// copied nodes still know the edges of their sources
+			foreach(Edge* e, n->getEdges())
+				if(e->getCurrentSystem() != this)
+					n->removeEdge(e);
+		}
+	}
+	mforeach(DataViewer* viewer, dataViewers)
+		viewer->migrateAllComponents(this);
+
+	// detach
+	std::vector<System*>& predSucessors = predecessorSys->sucessors;
+	predSucessors.erase(std::remove(predSucessors.begin(), predSucessors.end(), (System*)this), predSucessors.end());
+	predecessorSys->SQLUpdateStates();
+	predecessors.clear();
+	predecessorSys = NULL;
+	SQLUpdateStates();
+	return true;
+}
@@ -40,20 +40,35 @@ private:
 	bool allNodesLoaded;
 	bool allSubSystemsLoaded;
 
+	unsigned int copyCount;	// successor copies created in this state
+
 	const Component* getComponentReadOnly(std::string uuid) const;
+	const Component* getComponentReadOnlyByName(const QUuid& name) const;
 	const Edge* getEdgeReadOnly(Node* start, Node* end);
+	void LoadChilds(Components type);
 
 	Component* SuccessorCopy(const Component *src);
 	Node* SuccessorCopy(const Node *src);
 	Edge* SuccessorCopy(const Edge *src);
 	Face* SuccessorCopy(const Face *src);
+	// hands the copy to the data viewers, they replace src with it before their lists are used again
+	Component* RegisterCopy(const Component *src, Component *copy);
 public:
 	DerivedSystem(System* sys);
 
 	Component* SuccessorCopyTypesafe(const Component *src);
+	/** @brief returns the number of components copied from the predecessor states into this state */
+	unsigned int getCopyCount() const {return copyCount;}
+	/** @brief returns the number of predecessor states a lookup may walk through, 0 if flattened */
+	unsigned int getDepth() const;
+	/** @brief copies everything this state still reads from its predecessors into it and detaches it
+	* from them, lookups don't walk the predecessor chain anymore and the predecessors may be deleted.
+	* Returns false if the state has successors or the chain holds subsystems, nothing is done then */
+	bool Flatten();
 
 	//Node* getNode(QUuid uuid);
 	Component* getComponent(std::string uuid);
+	Component* getComponentByName(const QUuid& name);
 	Node* getNode(std::string uuid);
 	Edge* getEdge(std::string uuid);
 	Edge* getEdge(Node* start, Node* end);
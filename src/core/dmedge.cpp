@@ -106,8 +106,7 @@ void Edge::setStartpoint(Node *start)
 
 void Edge::setStartpointName(std::string name)
 {
-	QMutexLocker ml(mutex);
-
+	// do not hold the edge lock while waiting for the system lock
 	if(!currentSys)
 	{
 		Logger(Error) << "setStartpointName in unattached edge not possible";
@@ -127,8 +126,7 @@ void Edge::setEndpoint(Node *end)
 
 void Edge::setEndpointName(std::string name)
 {
-	QMutexLocker ml(mutex);
-
+	// do not hold the edge lock while waiting for the system lock
 	if(!currentSys)
 	{
 		Logger(Error) << "setEndpointName in unattached edge not possible";
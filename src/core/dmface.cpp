@@ -159,8 +159,10 @@ void Face::addHole(std::vector<std::string> hole)
 
 void Face::addHole(std::vector<Node*> hole)
 {
+	// do not hold the face lock while waiting for the system lock
+	Face* holeFace = getCurrentSystem()->addFace(hole);
 	QMutexLocker ml(mutex);
-	_holes.push_back(getCurrentSystem()->addFace(hole));
+	_holes.push_back(holeFace);
 }
 
 void Face::addHole(Face* hole)
@@ -40,6 +40,7 @@ Module::Module()
 	status = MOD_UNTOUCHED;
 	owner = NULL;
 	successorMode = false;
+	streamChanged = true;
 }
 Module::~Module()
 {
@@ -151,6 +152,8 @@ void Module::setName(std::string name)
 
 void Module::addPort(const std::string &name, const PortType type)
 {
+	streamChanged = true;
+
 	if(type == INPORT)
 		inPorts[name] = NULL;
 	else if(type == OUTPORT)
@@ -162,6 +165,8 @@ void Module::addPort(const std::string &name, const PortType type)
 
 void Module::removePort(const std::string &name, const PortType type)
 {
+	streamChanged = true;
+
 	if(type == INPORT)
 		inPorts.erase(name);
 	else if(type == OUTPORT)
@@ -227,6 +232,8 @@ System* Module::getOutPortData(const std::string &name) const
 
 void Module::addData(const std::string& streamName, const std::vector<View>& views)
 {
+	streamChanged = true;
+
 	if(views.size())
 	{
 		std::map<std::string,View>& accessedViews = this->accessedViews[streamName];
@@ -255,6 +262,8 @@ void Module::addData(const std::string& streamName, const std::vector<View>& vie
 
 void Module::removeData(const std::string& name)
 {
+	streamChanged = true;
+
 	accessedViews.erase(name);
 
 	if(hasInPort(name))
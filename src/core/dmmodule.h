@@ -295,6 +295,11 @@ private:
 	Module*			owner;
 	bool			successorMode;
 	std::string		name;
+
+	// set if ports or views changed since the last stream check, see simulation::checkStream
+	bool			streamChanged;
+	// parameter values at the time of the last stream check
+	std::string		checkedParameters;
 };
 
 }
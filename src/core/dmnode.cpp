@@ -27,6 +27,7 @@
 #include <dmcomponent.h>
 #include <dmnode.h>
 #include <dmedge.h>
+#include <dmsystem.h>
 #include <cstdlib>
 #include <math.h>
 
@@ -36,12 +37,19 @@
 
 using namespace DM;
 
+#define NODE_X (storage != INLINE ? slot.block->x[slot.id%NODESTORE_BLOCK_SIZE] : coordinates[0])
+#define NODE_Y (storage != INLINE ? slot.block->y[slot.id%NODESTORE_BLOCK_SIZE] : coordinates[1])
+#define NODE_Z (storage != INLINE ? slot.block->z[slot.id%NODESTORE_BLOCK_SIZE] : coordinates[2])
+
 Node::Node( double x, double y, double z) : 
-	Component(true),
-	vector(x,y,z)
+	Component(true)
 {
 	isInserted = false;
 	connectedEdges = 0;
+	storage = INLINE;
+	coordinates[0] = x;
+	coordinates[1] = y;
+	coordinates[2] = z;
 }
 
 Node::Node() : 
@@ -49,30 +57,103 @@ Node::Node() :
 {
 	isInserted = false;
 	connectedEdges = 0;
+	storage = INLINE;
+	coordinates[0] = coordinates[1] = coordinates[2] = 0.0;
 }
 
 Node::Node(const Node& n) : 
-	Component(n, true),
-	vector(n.vector)
+	Component(n, true)
 {
 	isInserted = false;
 	connectedEdges = 0;
+	storage = INLINE;
+	n.get(coordinates);
 	if(n.connectedEdges)
 		foreach(Edge* e, *n.connectedEdges)
 		this->addEdge(e);
 }
+
+Node::Node(NodeStore* store, unsigned int id) : 
+	Component(true)
+{
+	isInserted = false;
+	connectedEdges = 0;
+	storage = ATTACHED;
+	slot.store = store;
+	slot.block = store->GetBlock(id);
+	slot.id = id;
+	store->SetHandle(id, this);
+}
+
 Node::~Node()
 {
+	Detach();
 	if(connectedEdges)	delete connectedEdges;
 }
+
+void Node::Attach(NodeStore* store)
+{
+	if(storage != INLINE && slot.store == store)
+		return;
+
+	Detach();
+	double v[3] = {coordinates[0], coordinates[1], coordinates[2]};
+	slot.id = store->Add(v[0], v[1], v[2], this);
+	slot.block = store->GetBlock(slot.id);
+	slot.store = store;
+	storage = ATTACHED;
+}
+
+void Node::Detach()
+{
+	if(storage == INLINE)
+		return;
+
+	double v[3];
+	get(v);
+	if(storage == ATTACHED)
+		slot.store->Release(slot.id);
+	else
+		slot.block->pins.deref();
+	storage = INLINE;
+	coordinates[0] = v[0];
+	coordinates[1] = v[1];
+	coordinates[2] = v[2];
+}
+
+void Node::ShareCoordinates(const Node* src, NodeStore* store)
+{
+	if(src->storage == INLINE)
+		return;
+
+	Detach();
+	slot.store = store;
+	slot.block = src->slot.block;
+	slot.id = src->slot.id;
+	storage = SHARED;
+	// the predecessor keeps the slot until we are done with it
+	slot.block->pins.ref();
+}
+
+void Node::Unshare()
+{
+	NodeStore* ownStore = slot.store;
+	Detach();
+	// the store of the own system is synchronized by the system
+	if(currentSys)
+	{
+		QMutexLocker ml(currentSys->mutex);
+		Attach(ownStore);
+	}
+}
 void Node::SetOwner(Component *owner)
 {
 	QMutexLocker ml(mutex);
 
 	currentSys = owner->getCurrentSystem();
 
-	mforeach(Attribute* a, ownedattributes)
-		a->setOwner(this);
+	for(unsigned int i=0;i<ownedattributes.size();i++)
+		ownedattributes.at(i).attribute->setOwner(this);
 }
 
 DM::Components Node::getType() const
@@ -85,22 +166,24 @@ QString Node::getTableName()
 }
 double Node::getX() const
 {
-	return vector.x;
+	return NODE_X;
 }
 
 double Node::getY() const
 {
-	return vector.y;
+	return NODE_Y;
 }
 
 double Node::getZ() const
 {
-	return vector.z;
+	return NODE_Z;
 }
 
-void Node::get(double *vector) const
+void Node::get(double *xyz) const
 {
-	memcpy(vector, &this->vector, sizeof(this->vector));
+	xyz[0] = NODE_X;
+	xyz[1] = NODE_Y;
+	xyz[2] = NODE_Z;
 }
 
 const double Node::get(unsigned int i) const {
@@ -123,25 +206,34 @@ std::vector<Edge*> Node::getEdges() const
 
 void Node::set(double x, double y, double z)
 {
+	// locks the system, not while holding our own lock
+	if(storage == SHARED)
+		Unshare();
 	QMutexLocker ml(mutex);
-	vector.x = x;
-	vector.y = y;
-	vector.z = z;
+	NODE_X = x;
+	NODE_Y = y;
+	NODE_Z = z;
 }
 
 void Node::setX(double x)
 {
-	vector.x = x;
+	if(storage == SHARED)
+		Unshare();
+	NODE_X = x;
 }
 
 void Node::setY(double y)
 {
-	vector.y = y;
+	if(storage == SHARED)
+		Unshare();
+	NODE_Y = y;
 }
 
 void Node::setZ(double z)
 {
-	vector.z = z;
+	if(storage == SHARED)
+		Unshare();
+	NODE_Z = z;
 }
 
 Component* Node::clone()
@@ -151,11 +243,13 @@ Component* Node::clone()
 
 Node& Node::operator=(const Node& other)
 {
+	if(storage == SHARED)
+		Unshare();
 	QMutexLocker ml(mutex);
 
 	if(this != &other)
 	{
-		vector = other.vector;
+		set(other.getX(), other.getY(), other.getZ());
 
 		if(!connectedEdges && other.connectedEdges)
 			foreach(Edge* e, *other.connectedEdges)
@@ -166,45 +260,48 @@ Node& Node::operator=(const Node& other)
 
 bool Node::operator ==(const Node & other) const 
 {
-	return 0 == memcmp(&vector, &other.vector, sizeof(vector));
+	double a[3], b[3];
+	get(a);
+	other.get(b);
+	return 0 == memcmp(a, b, sizeof(a));
 }
 
 const Node Node::operator -(const Node & other) const 
 {
-	return Node(vector.x - other.vector.x,
-				vector.y - other.vector.y,
-				vector.z - other.vector.z);
+	return Node(getX() - other.getX(),
+				getY() - other.getY(),
+				getZ() - other.getZ());
 }
 
 const Node Node::operator +(const Node & other) const 
 {
-	return Node(vector.x + other.vector.x,
-				vector.y + other.vector.y,
-				vector.z + other.vector.z);
+	return Node(getX() + other.getX(),
+				getY() + other.getY(),
+				getZ() + other.getZ());
 }
 const Node Node::operator *(const double &val) const
 {
-	return Node(vector.x * val,
-				vector.y * val,
-				vector.z * val);
+	return Node(getX() * val,
+				getY() * val,
+				getZ() * val);
 }
 
 const Node Node::operator /(const double &val) const
 {
-	return Node(vector.x / val,
-				vector.y / val,
-				vector.z / val);
+	return Node(getX() / val,
+				getY() / val,
+				getZ() / val);
 }
 
 bool Node::compare2d(const Node &other, double round ) const 
 {
-	return fabs(vector.x - other.vector.x) <= round 
-		&& fabs(vector.y - other.vector.y) <= round;
+	return fabs(getX() - other.getX()) <= round 
+		&& fabs(getY() - other.getY()) <= round;
 }
 bool Node::compare2d(const Node * other , double round ) const 
 {
-	return fabs(vector.x - other->vector.x) <= round 
-		&& fabs(vector.y - other->vector.y) <= round;
+	return fabs(getX() - other->getX()) <= round 
+		&& fabs(getY() - other->getY()) <= round;
 }
 
 void Node::addEdge(Edge* e)
@@ -30,6 +30,7 @@
 #include <dmcompilersettings.h>
 #include "dmdbconnector.h"
 #include "dmcomponent.h"
+#include "dmnodestore.h"
 
 #ifdef SWIG
 #define DM_HELPER_DLL_EXPORT
@@ -60,10 +61,15 @@ public:
 * to the node objects.
 * Nodes are derived from the Component class. Therefore nodes are identified by an UUID and can hold an
 * unlimeted number of Attributes.
+* Nodes added to a system keep their coordinates in the NodeStore of the system, other nodes in
+* the node itself. Successor copies read the coordinates from the store of the predecessor state
+* until they are changed.
 */
 class DM_HELPER_DLL_EXPORT Node : public Component
 {
 	friend class Edge;
+	friend class System;
+	friend class DerivedSystem;
 public:
 	/** @brief create new Node object defined by x, y and z */
 	Node( double x, double y, double z );
@@ -143,8 +149,39 @@ private:
 	QString getTableName();
 	void addEdge(Edge* e);
 	void removeEdge(Edge* e);
-	
-	Vector3 vector;
+
+	/** @brief materializes the node stored with the given id */
+	Node(NodeStore* store, unsigned int id);
+	/** @brief moves the coordinates into the store */
+	void Attach(NodeStore* store);
+	/** @brief moves the coordinates out of the store */
+	void Detach();
+	/** @brief reads the coordinates from the store slot of src until they are changed, for successor copies */
+	void ShareCoordinates(const Node* src, NodeStore* store);
+	/** @brief moves shared coordinates into the store of the own system before they are changed */
+	void Unshare();
+	bool SharesBlock() const {return storage == SHARED;}
+
+	enum Storage
+	{
+		INLINE,		// coordinates are kept in the node
+		ATTACHED,	// slot of the store
+		SHARED		// slot of the store of a predecessor state, read until the node is changed
+	};
+	struct Slot
+	{
+		NodeStore* store;	// the store of the own system, for shared slots too
+		NodeStore::Block* block;
+		unsigned int id;
+	};
+
+	unsigned char storage;	// Storage
+	// a node attached to a store doesn't need its own copy of the coordinates
+	union
+	{
+		double coordinates[3];
+		Slot slot;
+	};
 	std::list<Edge*> *connectedEdges;	// not cached, for now
 };
 
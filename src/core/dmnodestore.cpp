@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#include <dmnodestore.h>
+
+using namespace DM;
+
+NodeStore::NodeStore()
+{
+	size = 0;
+	lazyCount = 0;
+}
+
+NodeStore::~NodeStore()
+{
+	for(unsigned int i=0;i<blocks.size();i++)
+		delete blocks[i];
+}
+
+unsigned int NodeStore::Add(double x, double y, double z, Node* handle)
+{
+	unsigned int id;
+	if(!freeIds.size() && pinnedIds.size())
+		ReclaimPinnedIds();
+	if(freeIds.size())
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+		alive[id] = true;
+	}
+	else
+	{
+		id = size++;
+		if(id/NODESTORE_BLOCK_SIZE >= blocks.size())
+			blocks.push_back(new Block);
+		alive.push_back(true);
+	}
+
+	Block* b = GetBlock(id);
+	unsigned int i = id%NODESTORE_BLOCK_SIZE;
+	b->x[i] = x;
+	b->y[i] = y;
+	b->z[i] = z;
+	b->handles[i] = handle;
+	if(!handle)
+		lazyCount++;
+	return id;
+}
+
+void NodeStore::Release(unsigned int id)
+{
+	if(!IsAlive(id))
+		return;
+
+	Block* b = GetBlock(id);
+	if(!b->handles[id%NODESTORE_BLOCK_SIZE])
+		lazyCount--;
+	b->handles[id%NODESTORE_BLOCK_SIZE] = NULL;
+	alive[id] = false;
+	// successor states may still read the coordinates
+	if(b->pins > 0)
+		pinnedIds.push_back(id);
+	else
+		freeIds.push_back(id);
+}
+
+void NodeStore::ReclaimPinnedIds()
+{
+	unsigned int kept = 0;
+	for(unsigned int i=0;i<pinnedIds.size();i++)
+	{
+		if(GetBlock(pinnedIds[i])->pins > 0)
+			pinnedIds[kept++] = pinnedIds[i];
+		else
+			freeIds.push_back(pinnedIds[i]);
+	}
+	pinnedIds.resize(kept);
+}
+
+void NodeStore::SetHandle(unsigned int id, Node* handle)
+{
+	Block* b = GetBlock(id);
+	Node*& h = b->handles[id%NODESTORE_BLOCK_SIZE];
+	if(!h && handle)
+		lazyCount--;
+	else if(h && !handle)
+		lazyCount++;
+	h = handle;
+}
+
+long long NodeStore::GetMemoryUsage() const
+{
+	return (long long)blocks.size()*sizeof(Block)
+		+ blocks.capacity()*sizeof(Block*)
+		+ alive.capacity()/8
+		+ (freeIds.capacity() + pinnedIds.capacity())*sizeof(unsigned int);
+}
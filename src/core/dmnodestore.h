@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @version 1.0
+ * @section LICENSE
+ * This file is part of DynaMind
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+#ifndef DMNODESTORE_H
+#define DMNODESTORE_H
+
+#include <dmcompilersettings.h>
+#include <vector>
+#include <cstddef>
+#include <QAtomicInt>
+
+namespace DM {
+
+class Node;
+
+// number of nodes per block of the node store
+#define NODESTORE_BLOCK_SIZE 512
+
+/**************************************************************//**
+@class DM::NodeStore
+@ingroup DynaMind-Core
+@brief Columnar storage of the node coordinates of a system.
+
+COMMENTS
+Coordinates are kept in blocks of NODESTORE_BLOCK_SIZE x, y and z
+values, addressed by a dense id. Blocks are never moved, so a Node
+attached to the store keeps a pointer to its block. A slot without
+handle is a node which has not been materialized yet, the system
+creates the Node object on the first access to it.
+Released ids are reused. Nodes of successor states may read the
+blocks of a predecessor store, ids released while their block is
+pinned by such nodes are reused after it has been unpinned.
+Modifications have to be synchronized by the owning system.
+
+******************************************************************/
+class DM_HELPER_DLL_EXPORT NodeStore
+{
+public:
+	struct Block
+	{
+		double	x[NODESTORE_BLOCK_SIZE];
+		double	y[NODESTORE_BLOCK_SIZE];
+		double	z[NODESTORE_BLOCK_SIZE];
+		Node*	handles[NODESTORE_BLOCK_SIZE];	// materialized node or NULL
+		QAtomicInt	pins;	// nodes of other stores reading this block
+	};
+
+	NodeStore();
+	~NodeStore();
+
+	//!< adds a node, returns its id. Without handle the node is not materialized
+	unsigned int Add(double x, double y, double z, Node* handle = NULL);
+	//!< frees the id, it may be reused by the next Add if its block is not pinned
+	void Release(unsigned int id);
+	//!< sets the materialized node of the id
+	void SetHandle(unsigned int id, Node* handle);
+
+	//!< returns the upper bound of all ids, including released ones
+	unsigned int Size() const			{return size;}
+	//!< returns the number of stored nodes
+	unsigned int Count() const			{return size - (unsigned int)(freeIds.size() + pinnedIds.size());}
+	//!< returns the number of nodes not materialized yet
+	unsigned int LazyCount() const		{return lazyCount;}
+	bool IsAlive(unsigned int id) const	{return id < size && alive[id];}
+
+	Block* GetBlock(unsigned int id) const	{return blocks[id/NODESTORE_BLOCK_SIZE];}
+	inline double X(unsigned int id) const	{return GetBlock(id)->x[id%NODESTORE_BLOCK_SIZE];}
+	inline double Y(unsigned int id) const	{return GetBlock(id)->y[id%NODESTORE_BLOCK_SIZE];}
+	inline double Z(unsigned int id) const	{return GetBlock(id)->z[id%NODESTORE_BLOCK_SIZE];}
+	inline Node* Handle(unsigned int id) const	{return GetBlock(id)->handles[id%NODESTORE_BLOCK_SIZE];}
+
+	//!< returns the bytes allocated by the store
+	long long GetMemoryUsage() const;
+private:
+	std::vector<Block*>	blocks;
+	std::vector<bool>	alive;
+	std::vector<unsigned int>	freeIds;
+	std::vector<unsigned int>	pinnedIds;	// released ids of pinned blocks
+	unsigned int	size;
+
+	// moves the ids of blocks not pinned anymore to freeIds
+	void ReclaimPinnedIds();
+	unsigned int	lazyCount;
+};
+
+}	// namespace DM
+
+#endif // DMNODESTORE_H
@@ -41,6 +41,7 @@ RasterData::RasterData(long width, long height,
 					   double xoffset, double yoffset)
 					   : Component(true)
 {
+	UseOwnMutex();
 	this->width = width;
 	this->height = height;
 	this->cellSizeX = cellsizeX;
@@ -60,6 +61,7 @@ RasterData::RasterData(long width, long height,
 }
 RasterData::RasterData() : Component(true)
 {
+	UseOwnMutex();
 	this->cellSizeX = 0;
 	this->cellSizeY = 0;
 	this->xoffset = 0;
@@ -72,6 +74,7 @@ RasterData::RasterData() : Component(true)
 }
 RasterData::RasterData(const RasterData &other) : Component(other, true)
 {
+	UseOwnMutex();
 	this->width = other.width;
 	this->height = other.height;
 	this->NoValue = other.NoValue;
@@ -384,7 +387,8 @@ void RasterData::SQLInsertField(long width, long height)
 	if(cache)
 		return;
 
-	cache = new DbCache<RasterBlockLabel*, QByteArray>(RASTERBLOCKCACHESIZE);
+	cache = new DbCache<RasterBlockLabel*, QByteArray>(RASTERBLOCKCACHESIZE,
+		DBConnector::getInstance()->GetCachePolicy());
 	blockLabels = new RasterBlockLabel[blWidth*blHeight];
 
 	double buffer[RASTERBLOCKSIZE*RASTERBLOCKSIZE];
@@ -422,12 +426,7 @@ void RasterData::SQLDeleteField()
 	delete blockLabels;
 	cache = NULL;
 
-	QSqlQuery *q = DBConnector::getInstance()->getQuery("DELETE FROM rasterfields WHERE owner LIKE ?");
-	if(q)
-	{
-		q->addBindValue(uuid.toByteArray());
-		DBConnector::getInstance()->ExecuteQuery(q);
-	}
+	DBConnector::getInstance()->getBackend()->DeleteRasterField(uuid);
 }
 
 double RasterData::SQLGetValue(long x, long y) const
@@ -471,46 +470,50 @@ void RasterData::SQLCopyField(const RasterData *ref)
 	long blHeight = height/RASTERBLOCKSIZE+1;
 
 	for(long x = 0; x<blWidth; x++)
+	{
+		// fetch all swapped out blocks of this column at once
+		QList<RasterBlockLabel*> column;
+		for(long y = 0; y<blHeight; y++)
+			column.append(&ref->blockLabels[x+y*blWidth]);
+		ref->cache->preCache(column);
+
 		for(long y = 0; y<blHeight; y++)
 			*cache->get(&blockLabels[x+y*blWidth]) = *ref->cache->get(&ref->blockLabels[x+y*blWidth]);
+	}
 }
 
 QByteArray* RasterData::RasterBlockLabel::LoadFromDb()
 {
-	QSqlQuery *q = DBConnector::getInstance()->getQuery("SELECT data FROM rasterfields WHERE owner LIKE ? AND x=? AND y=?");
-	q->addBindValue(backRef->uuid.toByteArray());
-	q->addBindValue(QVariant::fromValue(x));
-	q->addBindValue(QVariant::fromValue(y));
-	if(!DBConnector::getInstance()->ExecuteSelectQuery(q))
+	return DBConnector::getInstance()->getBackend()->LoadRasterBlock(backRef->uuid, x, y);
+}
+
+void RasterData::RasterBlockLabel::_PreCache(const QList<RasterBlockLabel*>& keys, QList<QByteArray*>& values)
+{
+	// group the requested blocks by raster and column
+	typedef std::pair<const RasterData*, long> Column;
+	std::map<Column, QList<int> > columns;
+	for(int i=0;i<keys.size();i++)
+		columns[Column(keys[i]->backRef, keys[i]->x)].append(i);
+
+	for(std::map<Column, QList<int> >::const_iterator it = columns.begin(); it != columns.end(); ++it)
 	{
-		delete q;
-		return NULL;
-	}
+		QList<long> ys;
+		QList<QByteArray*> data;
+		foreach(int i, it->second)
+		{
+			ys.append(keys[i]->y);
+			data.append(NULL);
+		}
+
+		DBConnector::getInstance()->getBackend()->LoadRasterBlocks(it->first.first->uuid, it->first.second, ys, &data);
 
-	QByteArray* qba = new QByteArray(q->value(0).toByteArray());
-	delete q;
-	return qba;
+		for(int j=0;j<data.size();j++)
+			values[it->second[j]] = data[j];
+	}
 }
 
 void RasterData::RasterBlockLabel::SaveToDb(QByteArray *qba)
 {
-	if(!isInserted)
-	{
-		QSqlQuery *q = DBConnector::getInstance()->getQuery("INSERT INTO rasterfields(owner,x,y,data) VALUES (?,?,?,?)");
-		q->addBindValue(backRef->uuid.toByteArray());
-		q->addBindValue(QVariant::fromValue(x));
-		q->addBindValue(QVariant::fromValue(y));
-		q->addBindValue(*qba);
-		DBConnector::getInstance()->ExecuteQuery(q);
-		isInserted = true;
-	}
-	else
-	{
-		QSqlQuery *q = DBConnector::getInstance()->getQuery("UPDATE rasterfields SET data=? WHERE owner=? AND x=? AND y=?");
-		q->addBindValue(*qba);
-		q->addBindValue(backRef->uuid.toByteArray());
-		q->addBindValue(QVariant::fromValue(x));
-		q->addBindValue(QVariant::fromValue(y));
-		DBConnector::getInstance()->ExecuteQuery(q);
-	}
+	DBConnector::getInstance()->getBackend()->SaveRasterBlock(backRef->uuid, x, y, *qba, isInserted);
+	isInserted = true;
 }
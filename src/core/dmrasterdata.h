@@ -175,6 +175,8 @@ private:
 		bool isInserted;
 		QByteArray* LoadFromDb();
 		void SaveToDb(QByteArray *qba);
+		/** @brief loads all given blocks with one bulk select per raster column, used by DbCache::preCache */
+		static void _PreCache(const QList<RasterBlockLabel*>& keys, QList<QByteArray*>& values);
 	};
 
 	/** @brief return table name */
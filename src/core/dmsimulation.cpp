@@ -48,6 +48,8 @@
 #include <dmgroup.h>
 #include <dmsimulationwriter.h>
 #include <dmlogger.h>
+#include <dmderivedsystem.h>
+#include <dmdataviewer.h>
 
 #ifndef PYTHON_EMBEDDING_DISABLED
 #include <dmpythonenv.h>
@@ -57,6 +59,9 @@
 #include <QDir>
 
 #include <QtConcurrentRun>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
 
 /*
 #ifdef _OPENMP
@@ -69,6 +74,10 @@ using namespace DM;
 Simulation::Simulation()
 {
 	status = SIM_OK;
+	parallelExecution = false;
+	streamChecked = false;
+	revalidatedModules = 0;
+	successorDepthLimit = 32;
 	moduleRegistry = new ModuleRegistry();
 }
 
@@ -103,17 +112,25 @@ void Simulation::removeModule(Module* m)
 	// TODO check if systems are lost
 	Logger(Debug) << "Removing module" << m->getName();
 
-	std::vector<Link*> toDelete;
+	std::set<Link*> toDelete;
 
-	foreach(Link* l, links)
-		if(l->dest == m || l->src == m)
-			toDelete.push_back(l);
+	mforeach(const std::vector<Link*>& portLinks, linksBySource.value(m))
+		foreach(Link* l, portLinks)
+			toDelete.insert(l);
+	mforeach(const std::vector<Link*>& portLinks, linksByDest.value(m))
+		foreach(Link* l, portLinks)
+			toDelete.insert(l);
 
 	foreach(Link* l, toDelete)
 	{
+		if(l->dest != m)
+			l->dest->streamChanged = true;
+		unindexLink(l);
 		links.remove(l);
 		delete l;
 	}
+	linksBySource.remove(m);
+	linksByDest.remove(m);
 
 	modules.remove(m);
 	delete m;
@@ -246,9 +263,9 @@ bool Simulation::isLinkingValid(Module* source, std::string outPort, Module* des
 	}
 
 	// check if the same link exists already
-	foreach(Link* l, links)
+	if(const std::vector<Link*>* destLinks = findLinks(linksByDest, dest, inPort))
 	{
-		if(l->dest == dest && l->inPort == inPort)
+		foreach(Link* l, *destLinks)
 		{
 			if(l->src == source && l->outPort == outPort)
 			{
@@ -278,6 +295,9 @@ bool Simulation::addLink(Module* source, std::string outPort, Module* dest, std:
 	l->isIntoGroupLink = (dest->owner == source);
 	l->isOutOfGroupLink = (source->owner == dest);
 	links.push_back(l);
+	indexLink(l);
+	// revalidate from the source on the next stream check
+	source->streamChanged = true;
 	// stream check
 	Logger(Debug) << "Added link from module '" << l->src->getClassName() << "' port '" << outPort
 		<< "' to module '" << l->dest->getClassName() << "' port '" << inPort << "'";
@@ -294,12 +314,11 @@ bool Simulation::addLink(Module* source, std::string outPort, Module* dest, std:
 bool Simulation::removeLink(Module* source, std::string outPort, Module* dest, std::string inPort)
 {
 	Link* toDelete = NULL;
-	foreach(Link* l, links)
+	const std::vector<Link*>* destLinks = findLinks(linksByDest, dest, inPort);
+	if(destLinks) foreach(Link* l, *destLinks)
 	{
 		if(	l->src == source &&
-			l->outPort == outPort &&
-			l->dest == dest &&
-			l->inPort == inPort)
+			l->outPort == outPort)
 		{
 			// reset resets all stream views
 			// lets keep the ones not affected by this link
@@ -314,6 +333,7 @@ bool Simulation::removeLink(Module* source, std::string outPort, Module* dest, s
 	}
 	if(toDelete)
 	{
+		unindexLink(toDelete);
 		links.remove(toDelete);
 		Logger(Debug) << "Deleted link from port " << outPort << "to" << inPort;
 		checkModuleStreamForward(dest);
@@ -322,40 +342,72 @@ bool Simulation::removeLink(Module* source, std::string outPort, Module* dest, s
 	return false;
 }
 
+void Simulation::indexLink(Link* l)
+{
+	linksBySource[l->src][l->outPort].push_back(l);
+	linksByDest[l->dest][l->inPort].push_back(l);
+}
+
+void Simulation::unindexLink(Link* l)
+{
+	std::vector<Link*>& srcLinks = linksBySource[l->src][l->outPort];
+	srcLinks.erase(std::remove(srcLinks.begin(), srcLinks.end(), l), srcLinks.end());
+	std::vector<Link*>& destLinks = linksByDest[l->dest][l->inPort];
+	destLinks.erase(std::remove(destLinks.begin(), destLinks.end(), l), destLinks.end());
+}
+
+const std::vector<Simulation::Link*>* Simulation::findLinks(
+	const QHash<const Module*, std::map<std::string, std::vector<Link*> > >& index,
+	const Module* m, const std::string& port) const
+{
+	QHash<const Module*, std::map<std::string, std::vector<Link*> > >::const_iterator it = index.find(m);
+	if(it == index.end())
+		return NULL;
+
+	std::map<std::string, std::vector<Link*> >::const_iterator portIt = it.value().find(port);
+	if(portIt == it.value().end())
+		return NULL;
+
+	return &portIt->second;
+}
+
 std::vector<Simulation::Link*> Simulation::getIngoingLinks(const Module* dest, const std::string& inPort) const
 {
 	std::vector<Simulation::Link*> ls;
-	foreach(Link* l, links)
-		if(	l->dest == dest && l->inPort == inPort && !l->isOutOfGroupLink)
-			ls.push_back(l);
+	if(const std::vector<Link*>* portLinks = findLinks(linksByDest, dest, inPort))
+		foreach(Link* l, *portLinks)
+			if(!l->isOutOfGroupLink)
+				ls.push_back(l);
 
 	return ls;
 }
 std::vector<Simulation::Link*> Simulation::getOutgoingLinks(const Module* src, const std::string& outPort) const
 {
 	std::vector<Simulation::Link*> ls;
-	foreach(Link* l, links)
-		if(	l->src == src && l->outPort == outPort && !l->isIntoGroupLink)
-			ls.push_back(l);
+	if(const std::vector<Link*>* portLinks = findLinks(linksBySource, src, outPort))
+		foreach(Link* l, *portLinks)
+			if(!l->isIntoGroupLink)
+				ls.push_back(l);
 
 	return ls;
 }
 std::vector<Simulation::Link*> Simulation::getIntoGroupLinks(const Module* src, const std::string& inPort) const
 {
 	std::vector<Simulation::Link*> ls;
-	foreach(Link* l, links)
-		if(	l->src == src && l->outPort == inPort && l->isIntoGroupLink)
-			ls.push_back(l);
+	if(const std::vector<Link*>* portLinks = findLinks(linksBySource, src, inPort))
+		foreach(Link* l, *portLinks)
+			if(l->isIntoGroupLink)
+				ls.push_back(l);
 
 	return ls;
 }
 std::vector<Simulation::Link*> Simulation::getOutOfGroupLinks(const Module* dest, const std::string& outPort) const
 {
 	std::vector<Simulation::Link*> ls;
-	foreach(Link* l, links)
-		if(	l->dest == dest && l->inPort == outPort && l->isOutOfGroupLink)
-			ls.push_back(l);
-
+	if(const std::vector<Link*>* portLinks = findLinks(linksByDest, dest, outPort))
+		foreach(Link* l, *portLinks)
+			if(l->isOutOfGroupLink)
+				ls.push_back(l);
 
 	return ls;
 }
@@ -375,6 +427,9 @@ bool Simulation::checkGroupStreamForward(Group* g, std::string streamName, bool
 	{
 		DM::Logger(DM::Debug) << "initializing group '" << g->getClassName() << "'";
 		g->init();
+		g->streamChanged = false;
+		g->checkedParameters = getParameterState(g);
+		revalidatedModules++;
 
 		nextLinks = getIntoGroupLinks(g, streamName);
 		curStreamViews = &g->streamViews[streamName];
@@ -444,6 +499,8 @@ bool Simulation::checkModuleStreamForward(Module* m)
 	}
 	DM::Logger(DM::Debug) << "initializing module '" << m->getClassName() << "'";
 	m->init();
+	m->checkedParameters = getParameterState(m);
+	revalidatedModules++;
 
 	// updated stream consist of input stream + written streams in this module
 	std::map<std::string, std::map<std::string,View> > updatedStreams = m->streamViews;
@@ -520,6 +577,8 @@ bool Simulation::checkModuleStreamForward(Module* m)
 			}
 		}
 	}
+	// check again next time
+	m->streamChanged = !success;
 	if(!success)
 		return success;
 
@@ -574,26 +633,237 @@ bool Simulation::checkModuleStreamForward(Module* m)
 bool Simulation::checkStream()
 {
 	bool success = true;
-	QList<QFuture<bool>*> results;
-	foreach(Module* m, modules)
-		if(m->getInPortNames().size() == 0)
-			checkModuleStreamForward(m);
-	//foreach(std::string outPort, m->getOutPortNames())
-	//	if(!checkModuleStreamForward(m, outPort))
-	//		success = false;
+	revalidatedModules = 0;
+	if(!streamChecked)
+	{
+		foreach(Module* m, modules)
+			if(m->getInPortNames().size() == 0)
+				checkModuleStreamForward(m);
+		//foreach(std::string outPort, m->getOutPortNames())
+		//	if(!checkModuleStreamForward(m, outPort))
+		//		success = false;
+		streamChecked = true;
+	}
+	else
+	{
+		// the stream views of all other modules are still valid from the last check,
+		// only revalidate changed modules, pushing the views to their downstream modules
+		std::vector<Module*> changedModules;
+		foreach(Module* m, modules)
+		{
+			if(m->getStatus() == MOD_EXECUTION_OK)
+				m->setStatus(MOD_CHECK_OK);
+			if(m->streamChanged || m->checkedParameters != getParameterState(m))
+				changedModules.push_back(m);
+			else
+			{
+				// revalidated modules are initialized on their check, the others still need it to
+				// reset their counters, e.g. the group conditions. init may declare the same data
+				// again, only views which really changed need a revalidation
+				std::map<std::string, std::map<std::string,View> > views = m->accessedViews;
+				m->init();
+				m->streamChanged = !(m->accessedViews == views);
+				if(m->streamChanged)
+					changedModules.push_back(m);
+			}
+		}
+		foreach(Module* m, changedModules)
+			// may already be done downstream of a preceding module
+			if(m->streamChanged || m->checkedParameters != getParameterState(m))
+				revalidateStream(m);
+	}
+	DM::Logger(DM::Debug) << "revalidated " << revalidatedModules << " modules";
+	return success;
+}
+
+bool Simulation::revalidateStream(Module* m)
+{
+	if(!m->isGroup())
+		return checkModuleStreamForward(m);
+
+	bool success = true;
+	Group* g = (Group*)m;
+	for(std::map<std::string, std::map<std::string,View> >::iterator it = g->streamViews.begin();
+		it != g->streamViews.end(); ++it)
+		if(!checkGroupStreamForward(g, it->first, true))
+			success = false;
 
 	return success;
 }
 
+std::string Simulation::getParameterState(const Module* m)
+{
+	std::string state;
+	foreach(Module::Parameter* p, m->getParameters())
+	{
+		state += p->name;
+		state += "=";
+		state += m->getParameterAsString(p->name);
+		state += ";";
+	}
+	return state;
+}
+
+/** @brief logs how many of the components accessed via the views of a module have been copied
+into its successor states */
+void LogDataAccess(Module* m)
+{
+	typedef std::map<std::string, std::map<std::string, View> > StreamViews;
+	StreamViews streams = m->getAccessedViews();
+	for(StreamViews::const_iterator it = streams.begin(); it != streams.end(); ++it)
+	{
+		DerivedSystem* sys = dynamic_cast<DerivedSystem*>(m->getOutPortData(it->first));
+		if(!sys)
+			continue;
+
+		unsigned int accessed = 0;
+		mforeach(const View& v, it->second)
+			if(DataViewer* viewer = sys->getDataViewer(v.getName()))
+				accessed += viewer->getAccessedCount();
 
-class Worlist: public std::list<Module*>
+		if(accessed || sys->getCopyCount())
+			Logger(Standard) << "module '" << m->getName() << "' stream '" << it->first << "': copied "
+				<< (long)sys->getCopyCount() << " components, accessed " << (long)accessed;
+	}
+}
+
+/** @brief ready queue of the scheduler. Modules are kept in insertion order, globally and per
+owning group (domain). Membership, removal and the ready count of a domain are O(1) */
+class Worklist
 {
 public:
+	Worklist(): cnt(0) {}
+
+	int size() const {return cnt;}
+
+	bool contains(Module* m) const {return entries.contains(m);}
+
+	/** @brief appends the module, if not already queued */
 	void unique_insert(Module* m)
 	{
-		if(find(begin(), end(), m) == end())
-			push_back(m);
+		if(entries.contains(m))
+			return;
+
+		Domain& d = domains[m->getOwner()];
+		Entry e;
+		e.global = order.insert(order.end(), m);
+		e.domain = d.modules.insert(d.modules.end(), m);
+		d.size++;
+		entries.insert(m, e);
+		cnt++;
+	}
+
+	void remove(Module* m)
+	{
+		QHash<Module*, Entry>::iterator it = entries.find(m);
+		if(it == entries.end())
+			return;
+
+		Domain& d = domains[m->getOwner()];
+		order.erase(it.value().global);
+		d.modules.erase(it.value().domain);
+		d.size--;
+		entries.erase(it);
+		cnt--;
+	}
+
+	/** @brief number of queued modules owned by the given group, NULL = root */
+	int domainSize(Module* domain) const
+	{
+		QHash<Module*, Domain>::const_iterator it = domains.find(domain);
+		return it == domains.end() ? 0 : it.value().size;
+	}
+
+	/** @brief queued modules owned by the given group, in insertion order */
+	std::list<Module*> getDomain(Module* domain) const
+	{
+		QHash<Module*, Domain>::const_iterator it = domains.find(domain);
+		return it == domains.end() ? std::list<Module*>() : it.value().modules;
+	}
+
+	/** @brief returns the next module to process: the first of the current domain,
+	if the domain is finished the first in the queue */
+	Module* next(Module* currentDomain) const
+	{
+		QHash<Module*, Domain>::const_iterator it = domains.find(currentDomain);
+		if(it != domains.end() && it.value().size > 0)
+			return it.value().modules.front();
+		return order.front();
+	}
+
+private:
+	struct Entry
+	{
+		std::list<Module*>::iterator global;
+		std::list<Module*>::iterator domain;
+	};
+	struct Domain
+	{
+		Domain(): size(0) {}
+		std::list<Module*>	modules;
+		int					size;	//!< std::list::size is linear
+	};
+
+	std::list<Module*>		order;
+	QHash<Module*, Entry>	entries;
+	QHash<Module*, Domain>	domains;
+	int						cnt;
+};
+
+/** @brief dispatches modules to the global thread pool and collects them as soon as they finished */
+class ModuleExecutor
+{
+public:
+	ModuleExecutor(): running(0) {}
+
+	/** @brief starts the execution of the module decoupled */
+	void start(Module* m)
+	{
+		running++;
+		QtConcurrent::run(this, &ModuleExecutor::execute, m);
+	}
+
+	/** @brief blocks till a module finished, returns the module and its execution time in ms */
+	Module* waitForNext(long& elapsed)
+	{
+		QMutexLocker ml(&mutex);
+		while(finished.size() == 0)
+			finishedCondition.wait(&mutex);
+
+		Module* m = finished.front().first;
+		elapsed = finished.front().second;
+		finished.pop_front();
+		running--;
+		return m;
+	}
+
+	/** @brief blocks till all started modules finished, results are discarded */
+	void waitForAll()
+	{
+		long elapsed;
+		while(running > 0)
+			waitForNext(elapsed);
 	}
+
+	/** @brief number of started modules which have not been fetched via waitForNext yet */
+	int getRunning() const {return running;};
+
+private:
+	void execute(Module* m)
+	{
+		QElapsedTimer modTimer;
+		modTimer.start();
+		m->run();
+
+		QMutexLocker ml(&mutex);
+		finished.push_back(std::pair<Module*, long>(m, (long)modTimer.elapsed()));
+		finishedCondition.wakeOne();
+	}
+
+	int								running;
+	QMutex							mutex;
+	QWaitCondition					finishedCondition;
+	std::list<std::pair<Module*, long> >	finished;
 };
 
 void Simulation::run()
@@ -617,7 +887,7 @@ void Simulation::run()
 	simtimer.restart();
 	Logger(Standard) << ">> starting simulation";
 	// get modules with no imput - beginning modules list
-	Worlist worklist;
+	Worklist worklist;
 	foreach(Module* m, modules)
 		if(m->inPortsSet())
 			worklist.unique_insert(m);
@@ -627,92 +897,74 @@ void Simulation::run()
 	// progress stuff
 	int cntModulesFinished = 0;
 	int numModulesToFinish = modules.size();
+	// members of each group, needed to reset them on every loop
+	std::map<Module*, std::vector<Module*> > groupMembers;
+	foreach(Module* m, modules)
+		if(m->getOwner())
+			groupMembers[m->getOwner()].push_back(m);
+	// modules are always executed via the thread pool, in serial mode we wait for each of them
+	ModuleExecutor executor;
 	// run modules
-	// if not started decoupled, the state of the future is canceled, started and finished
-	while(worklist.size() && !canceled)
+	while((worklist.size() || executor.getRunning()) && !canceled)
 	{
-		// get first element
-		Worlist::iterator it = worklist.begin();
-		Module* m = *it;
-		worklist.remove(m);
+		Module* finishedModule = NULL;
+		long elapsed = 0;
 
-		// check if we stay in our domain
-		if(m->getOwner() != currentGroupDomain)
+		if(parallelExecution)
 		{
-			// we are going into or out of the group
-			// - check if we have already finished the current one
-			bool groupFinished = true;
-			foreach(Module* n, worklist)
+			// dispatch all ready modules of the current domain, they are independent of each other,
+			// as branching data streams create successor states
+			foreach(Module* n, worklist.getDomain(currentGroupDomain))
 			{
-				if(n->getOwner() == currentGroupDomain)
+				if(!n->isGroup())
 				{
-					groupFinished = false;
-					break;
+					// if we execute a module more than once, our total module count increases
+					if(n->getStatus() == MOD_EXECUTION_OK)
+						numModulesToFinish++;
+					Logger(Standard) << "running module '" << n->getName() << "'";
+					n->setStatus(MOD_EXECUTING);
+					executor.start(n);
+					worklist.remove(n);
 				}
 			}
-			if(!groupFinished)
-			{
-				// still modules left in this group
-				worklist.unique_insert(m);
-				continue;
-			}
+			// groups and domain changes have to wait till all running modules are finished
+			if(executor.getRunning())
+				finishedModule = executor.waitForNext(elapsed);
 		}
 
-		if(!m->isGroup())
+		if(!finishedModule)
 		{
-			// if we execute a module more than once, our total module count increases
-			if(m->getStatus() == MOD_EXECUTION_OK)
-				numModulesToFinish++;
-			// execute module
-			Logger(Standard) << "running module '" << m->getName() << "'";
-			QElapsedTimer modTimer;
-			modTimer.start();
-			m->setStatus(MOD_EXECUTING);
-			QtConcurrent::run(m, &Module::run).waitForFinished();
-
-			// check for errors
-			ModuleStatus merr = m->getStatus();
-			if(m->getStatus() == MOD_EXECUTION_ERROR)
-			{
-				if(Module* owner = m->getOwner())
-					owner->setStatus(MOD_EXECUTION_ERROR);
+			// stay in our domain until all its ready modules are done,
+			// then continue with the next one in line (going into or out of a group)
+			Module* m = worklist.next(currentGroupDomain);
+			worklist.remove(m);
 
-				Logger(Error) << "module '" << m->getName() << "' failed after " << (long)modTimer.elapsed() << "ms";
-				this->status = DM::SIM_FAILED;
-				return;
+			if(!m->isGroup())
+			{
+				// if we execute a module more than once, our total module count increases
+				if(m->getStatus() == MOD_EXECUTION_OK)
+					numModulesToFinish++;
+				// execute module
+				Logger(Standard) << "running module '" << m->getName() << "'";
+				m->setStatus(MOD_EXECUTING);
+				executor.start(m);
+				finishedModule = executor.waitForNext(elapsed);
 			}
 			else
 			{
-				Logger(Standard)	<< "module '" << m->getName() << "' executed successfully (took "
-					<< (long)modTimer.elapsed() << "ms)";
-				m->setStatus(MOD_EXECUTION_OK);
-
-				// notify progress
-				cntModulesFinished++;
-				float progress = (float)cntModulesFinished/numModulesToFinish;
-				foreach(SimulationObserver* obs, observers)
-					obs->update(progress);
-			}
-			// shift data from out port to next inport
-			foreach(Module* nextModule, shiftModuleOutput(m))
-				worklist.unique_insert(nextModule);
-		}
-		else
-		{
-			Group* g = (Group*)m;
-			// we are now operating in domain g
-			currentGroupDomain = g;
+				Group* g = (Group*)m;
+				// we are now operating in domain g
+				currentGroupDomain = g;
 
-			Logger(Standard) << "running group '" << g->getName() << "'";
+				Logger(Standard) << "running group '" << g->getName() << "'";
 
-			if(g->condition())
-			{
-				Logger(Standard) << "condition fulfilled for group '" << g->getName() << "'";
-				// to ensure loop in loops are working properly, we init all modules of a
-				// group before starting it - resetting all internal counters
-				Logger(Debug) << "resetting modules in group";
-				foreach(Module* m, modules)
-					if(m->getOwner() == g)
+				if(g->condition())
+				{
+					Logger(Standard) << "condition fulfilled for group '" << g->getName() << "'";
+					// to ensure loop in loops are working properly, we init all modules of a
+					// group before starting it - resetting all internal counters
+					Logger(Debug) << "resetting modules in group";
+					foreach(Module* m, groupMembers[g])
 					{
 						// FIX: module::getData also searches output if the system is already created
 						for(std::map<std::string, System*>::iterator it = m->outPorts.begin(); it != m->outPorts.end(); ++it)
@@ -721,25 +973,73 @@ void Simulation::run()
 						m->init();
 					}
 
-				// execute group
-				g->setStatus(MOD_EXECUTING);
-				// instead of m::run() we simply shift the data to the first internal module
-				foreach(Module* nextModule, shiftGroupInput(g))
-					worklist.unique_insert(nextModule);
-			}
-			else
-			{
-				Logger(Standard) << "finishing group '" << g->getName() << "'";
-				// finish and shift data
-				g->setStatus(MOD_EXECUTION_OK);
-				foreach(Module* nextModule, shiftModuleOutput(g))
-					worklist.unique_insert(nextModule);
-
-				// reset domain
-				currentGroupDomain = (Group*)g->getOwner();
+					// execute group
+					g->setStatus(MOD_EXECUTING);
+					// instead of m::run() we simply shift the data to the first internal module
+					foreach(Module* nextModule, shiftGroupInput(g))
+						worklist.unique_insert(nextModule);
+				}
+				else
+				{
+					Logger(Standard) << "finishing group '" << g->getName() << "'";
+					// finish and shift data
+					g->setStatus(MOD_EXECUTION_OK);
+					foreach(Module* nextModule, shiftModuleOutput(g))
+						worklist.unique_insert(nextModule);
+
+					// reset domain
+					currentGroupDomain = (Group*)g->getOwner();
+				}
+				continue;
 			}
 		}
+
+		// check for errors
+		Module* m = finishedModule;
+		if(m->getStatus() == MOD_EXECUTION_ERROR)
+		{
+			if(Module* owner = m->getOwner())
+				owner->setStatus(MOD_EXECUTION_ERROR);
+
+			Logger(Error) << "module '" << m->getName() << "' failed after " << elapsed << "ms";
+			this->status = DM::SIM_FAILED;
+			// modules of other branches may still work on their data
+			executor.waitForAll();
+			return;
+		}
+		else
+		{
+			Logger(Standard)	<< "module '" << m->getName() << "' executed successfully (took "
+				<< elapsed << "ms)";
+			LogDataAccess(m);
+			m->setStatus(MOD_EXECUTION_OK);
+
+			// compact long successor chains, e.g. of loop groups. Running modules may read
+			// the predecessors of the chain, so this waits for a moment nothing else runs
+			if(successorDepthLimit && !executor.getRunning())
+				mforeach(System* sys, m->outPorts)
+				{
+					DerivedSystem* derived = dynamic_cast<DerivedSystem*>(sys);
+					if(derived && derived->getDepth() > successorDepthLimit)
+						compactState(derived);
+				}
+			// trees left behind by earlier compactions may not be used anymore
+			if(detachedStates.size())
+				freeDetachedStates();
+
+			// notify progress
+			cntModulesFinished++;
+			float progress = (float)cntModulesFinished/numModulesToFinish;
+			foreach(SimulationObserver* obs, observers)
+				obs->update(progress);
+		}
+		// shift data from out port to next inport
+		foreach(Module* nextModule, shiftModuleOutput(m))
+			worklist.unique_insert(nextModule);
 	}
+	// on cancel, wait for all modules still running
+	executor.waitForAll();
+
 	if(canceled)
 	{
 		Logger(Standard) << ">> canceled simulation (time elapsed " << (long)simtimer.elapsed() << "ms)";
@@ -845,6 +1145,70 @@ std::set<Module*> Simulation::shiftModuleOutput(Module* m)
 	return nextModules;
 }
 
+bool Simulation::compactState(System* sys)
+{
+	DerivedSystem* derived = dynamic_cast<DerivedSystem*>(sys);
+	if(!derived)
+		return false;
+
+	System* root = sys;
+	while(root->getPredecessors().size())
+		root = root->getPredecessors()[0];
+
+	if(root == sys)
+		return true;
+
+	QElapsedTimer timer;
+	timer.start();
+	unsigned int depth = derived->getDepth();
+	if(!derived->Flatten())
+	{
+		Logger(Debug) << "successor state can't be flattened";
+		return false;
+	}
+	detachedStates.insert(root);
+	freeDetachedStates();
+	Logger(Debug) << "flattened " << (long)depth << " successor states (took " << (long)timer.elapsed() << "ms)";
+	return true;
+}
+
+void Simulation::freeDetachedStates()
+{
+	std::set<System*> referenced;
+	foreach(Module* m, this->modules)
+	{
+		foreach(std::string portName, m->getInPortNames())
+			if(System* sys = m->getInPortData(portName))
+				referenced.insert(sys);
+		foreach(std::string portName, m->getOutPortNames())
+			if(System* sys = m->getOutPortData(portName))
+				referenced.insert(sys);
+	}
+
+	std::vector<System*> unused;
+	foreach(System* root, detachedStates)
+	{
+		// walk the whole tree, the root deletes all its successors
+		bool used = false;
+		std::vector<System*> states(1, root);
+		while(states.size() && !used)
+		{
+			System* sys = states.back();
+			states.pop_back();
+			used = referenced.find(sys) != referenced.end();
+			foreach(System* successor, sys->getSucessors())
+				states.push_back(successor);
+		}
+		if(!used)
+			unused.push_back(root);
+	}
+	foreach(System* root, unused)
+	{
+		detachedStates.erase(root);
+		delete root;
+	}
+}
+
 std::set<Module*> Simulation::shiftGroupInput(Group* g)
 {
 	std::set<Module*> nextModules;
@@ -891,6 +1255,10 @@ void Simulation::reset()
 				if(sys->getPredecessors().size() == 0)
 					systems.insert(sys);
 	}
+	// including the trees left behind by compaction
+	foreach(System* sys, detachedStates)
+		systems.insert(sys);
+	detachedStates.clear();
 	// delete them
 	foreach(System* sys, systems)
 		delete sys;
@@ -901,6 +1269,7 @@ void Simulation::reset()
 		m->reset();
 		m->setStatus(MOD_UNTOUCHED);
 	}
+	streamChecked = false;
 	checkStream();
 }
 
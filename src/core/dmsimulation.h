@@ -31,8 +31,10 @@
 #include "dmcompilersettings.h"
 #include <string>
 #include <vector>
+#include <set>
 #include <dmmodule.h>
 #include <dmsystem.h>
+#include <QHash>
 
 namespace DM {
 
@@ -140,6 +142,29 @@ public:
 	/** @brief Resets the whole simulation, deprecated, for backwards compatibility */
 	void resetSimulation() {reset();};
 
+	/** @brief enables concurrent execution of modules in independent branches, default is off.
+	Modules of the same group domain, which have all in-ports set, get dispatched to the thread pool
+	at once; groups and domain changes are still processed one after another */
+	void setParallelExecution(bool parallel) {parallelExecution = parallel;};
+
+	/** @brief returns true if modules of independent branches are executed concurrently */
+	bool isParallelExecution() const {return parallelExecution;};
+
+	/** @brief returns the number of modules (re-)validated by the last stream check. After the first
+	check only modules with changed parameters, ports, views or links and their downstream modules are revalidated */
+	int getRevalidatedModuleCount() const {return revalidatedModules;};
+
+	/** @brief successor states with more predecessor levels than this get compacted after the module
+	writing them finished, see compactState. 0 disables it, default is 32 */
+	void setSuccessorDepthLimit(unsigned int depth) {successorDepthLimit = depth;};
+
+	/** @brief returns the depth above which successor states get compacted */
+	unsigned int getSuccessorDepthLimit() const {return successorDepthLimit;};
+
+	/** @brief flattens the successor state, see DerivedSystem::Flatten. Its former predecessor states
+	are deleted as soon as no module port refers to any of them. Returns false if the state can't be flattened */
+	bool compactState(System* sys);
+
 	/** @brief Cancels thin simulation, waits till the currently running module finishes.
 	All successing modules get skipped */
 	void cancel();
@@ -212,18 +237,37 @@ private:
 	returns destination module */
 	std::set<Module*> shiftGroupInput(Group* m);
 
+	/** @brief deletes the state trees detached by compactState which no module port refers to anymore */
+	void freeDetachedStates();
+
 	/** @brief checks the whole simulation stream for possible missing views */
 	bool checkStream();
 
 	/** @brief checks the stream beginning with this module for possible missing views */
 	bool checkModuleStreamForward(Module* m);
 
+	/** @brief revalidates the stream beginning with this module or group, using the cached stream views */
+	bool revalidateStream(Module* m);
+
+	/** @brief returns all parameter values of the module as one string, used to detect changes */
+	static std::string getParameterState(const Module* m);
+
 	/** @brief checks the stream beginning with this link for possible missing views */
 	bool checkModuleStreamForward(Link* link);
 
 	/** @brief checks the stream beginning with this group for possible missing views */
 	bool checkGroupStreamForward(Group* g, std::string streamName, bool into);
 
+	/** @brief adds the link to the port adjacency index */
+	void indexLink(Link* l);
+
+	/** @brief removes the link from the port adjacency index */
+	void unindexLink(Link* l);
+
+	/** @brief returns all links connected to the given port, NULL if there are none */
+	const std::vector<Link*>* findLinks(const QHash<const Module*, std::map<std::string, std::vector<Link*> > >& index,
+		const Module* m, const std::string& port) const;
+
 	/** @brief returns all links connected to this port */
 	std::vector<Link*> getIngoingLinks(const Module* dest, const std::string& inPort) const;
 
@@ -237,8 +281,18 @@ private:
 	std::vector<Link*> getOutOfGroupLinks(const Module* dest, const std::string& outPort) const;
 
 	bool canceled;
+	bool parallelExecution;
+	bool streamChecked;
+	int revalidatedModules;
+	unsigned int successorDepthLimit;
+	/** @brief roots of the state trees left behind by compactState */
+	std::set<System*>	detachedStates;
 	std::list<Module*>	modules;
 	std::list<Link*>	links;
+	/** @brief adjacency index of links, source module -> out port -> links */
+	QHash<const Module*, std::map<std::string, std::vector<Link*> > >	linksBySource;
+	/** @brief adjacency index of links, destination module -> in port -> links */
+	QHash<const Module*, std::map<std::string, std::vector<Link*> > >	linksByDest;
 	SimulationStatus	status;
 	ModuleRegistry*		moduleRegistry;
 	std::vector<SimulationObserver*>	observers;
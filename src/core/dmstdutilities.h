@@ -30,6 +30,17 @@
 
 #include <map>
 #include <vector>
+#include <QHash>
+#include <QUuid>
+
+#if QT_VERSION < 0x050000
+/** @brief hash function for QUuid keys, Qt4 does not offer one */
+inline uint qHash(const QUuid &uuid)
+{
+	return uuid.data1 ^ uuid.data2 ^ (uuid.data3 << 16)
+		^ ((uuid.data4[0] << 24) | (uuid.data4[1] << 16) | (uuid.data4[6] << 8) | uuid.data4[7]);
+}
+#endif
 
 /** @brief checks if a map contains the given key */
 template <typename T1, typename T2>
@@ -50,6 +61,24 @@ inline bool map_contains(const std::map<T1,T2> *m, const T1 &key, T2 &result)
 	return true;
 }
 
+/** @brief checks if a hash contains the given key */
+template <typename T1, typename T2>
+inline bool map_contains(const QHash<T1,T2> *m, const T1 &key)
+{
+	return m->contains(key);
+}
+
+/** @brief checks if a hash contains the given key and copies it into parameter 'result'*/
+template <typename T1, typename T2>
+inline bool map_contains(const QHash<T1,T2> *m, const T1 &key, T2 &result)
+{
+	typename QHash<T1,T2>::const_iterator i = m->constFind(key);
+	if(i==m->constEnd())	return false;
+
+	result = i.value();
+	return true;
+}
+
 /** @brief removes an element from a map */
 template <typename T1, typename T2>
 inline bool remove_element(std::map<T1,T2> *m, const T1 &key)
@@ -36,17 +36,18 @@
 #include <dmdbconnector.h>
 #include <QSqlQuery>
 #include <QUuid>
+#include <set>
 
 using namespace DM;
 
 System::System() : Component(true)
 {
 	//this->lastModule = 0;
-	//this->mutex = new QMutex(QMutex::Recursive);
+	// systems lock their children while holding their own lock
+	UseOwnMutex();
 
 	currentSys = this;
 
-	ownedchilds = std::map<QUuid, Component*>();
 	DBConnector::getInstance();
 	SQLInsert();
 }
@@ -146,7 +147,7 @@ System::System(const System& s) : Component(s, true)
 
 System::~System()
 {
-	mforeach(Component* c, ownedchilds)
+	foreach(Component* c, ownedchilds)
 		delete c;
 
 	ownedchilds.clear();
@@ -199,10 +200,18 @@ Component * System::getComponent(std::string uuid)
 {
 	return this->getChild(uuid);
 }
+Component * System::getComponentByName(const QUuid& name)
+{
+	return this->getChildByName(name);
+}
 const Component * System::getComponentReadOnly(std::string uuid) const
 {
 	return this->getChild(uuid);
 }
+const Component * System::getComponentReadOnlyByName(const QUuid& name) const
+{
+	return this->getChildByName(name);
+}
 const Edge * System::getEdgeReadOnly(Node* start, Node* end)
 {
 	return (const Edge*)getEdge(start,end);
@@ -221,6 +230,7 @@ Node* System::addNode(Node* node, const DM::View & view)
 		return 0;
 	}
 	nodes[node->getQUUID()] = node;
+	node->Attach(&nodeStore);
 
 	addComponentToView(node, view);
 
@@ -238,6 +248,35 @@ Node * System::addNode(double x, double y, double z,  const DM::View & view)
 	return this->addNode(new Node(x, y, z), view);
 }
 
+void System::addNodes(const std::vector<double>& coordinates)
+{
+	QMutexLocker ml(mutex);
+	for(unsigned int i=0;i+2<coordinates.size();i+=3)
+		nodeStore.Add(coordinates[i], coordinates[i+1], coordinates[i+2]);
+}
+
+const NodeStore* System::getNodeStore() const
+{
+	return &nodeStore;
+}
+
+void System::MaterializeNodes()
+{
+	QMutexLocker ml(mutex);
+	if(!nodeStore.LazyCount())
+		return;
+
+	for(unsigned int id=0;id<nodeStore.Size();id++)
+	{
+		if(nodeStore.IsAlive(id) && !nodeStore.Handle(id))
+		{
+			Node* n = new Node(&nodeStore, id);
+			addChild(n);
+			nodes[n->getQUUID()] = n;
+		}
+	}
+}
+
 Node* System::getNode(std::string uuid)
 {
 	Component* c = getChild(uuid);
@@ -261,7 +300,7 @@ bool System::removeNode(std::string name)
 
 	QUuid quuid = getChild(name)->getQUUID();
 	//check if name is a node instance
-	if(nodes.find(quuid)==nodes.end())
+	if(!nodes.contains(quuid))
 		return false;
 
 	//remove node
@@ -270,20 +309,18 @@ bool System::removeNode(std::string name)
 
 
 	//find all connected edges and remove them
-	std::vector<std::string> connectededges;
-	std::map<QUuid,Edge*>::iterator ite;
-	for ( ite=edges.begin() ; ite != edges.end(); ite++ )
+	std::vector<QUuid> connectededges;
+	foreach(Edge* tmpedge, edges)
 	{
-		Edge* tmpedge = edges[(*ite).first];
 		if(tmpedge->getStartpoint() == quuid
 			|| tmpedge->getEndpoint() == quuid)
-			connectededges.push_back(tmpedge->getUUID());
+			connectededges.push_back(tmpedge->getQUUID());
 	}
-	nodes.erase(quuid);
+	nodes.remove(quuid);
 
 	for(unsigned int index=0; index<connectededges.size(); index++)
 	{
-		if(!removeEdge(connectededges[index]))
+		if(!removeChild(connectededges[index]))
 			return false;
 	}
 
@@ -343,13 +380,13 @@ bool System::removeEdge(std::string name)
 
 	QUuid quuid = getChild(name)->getQUUID();
 	//check if name is a edge instance
-	if(edges.find(quuid)==edges.end())
+	if(!edges.contains(quuid))
 		return false;
 
 	if(!removeChild(quuid))
 		return false;
 	DM::Edge * e  = this->getEdge(quuid);
-	edges.erase(quuid);
+	edges.remove(quuid);
 	return true;
 }
 
@@ -387,13 +424,13 @@ bool System::removeFace(std::string name)
 
 	QUuid quuid = getChild(name)->getQUUID();
 	//check if name is a edge instance
-	if(faces.find(quuid)==faces.end())
+	if(!faces.contains(quuid))
 		return false;
 
 	if(!removeChild(quuid))
 		return false;
 
-	faces.erase(quuid);
+	faces.remove(quuid);
 	return true;
 }
 
@@ -417,18 +454,25 @@ RasterData * System::addRasterData(RasterData *r, const DM::View & view)
 	return r;
 }
 
+void System::LoadChilds(Components type)
+{
+	if(type == NODE)
+		MaterializeNodes();
+}
+
 std::map<std::string, Component*>  System::getAllComponents()
 {
 	std::map<std::string, Component*> comps;
-	mforeach(Component* c, components)
+	foreach(Component* c, components)
 		comps[c->getUUID()] = c;
 
 	return comps;
 }
 std::map<std::string, Node*> System::getAllNodes()
 {
+	MaterializeNodes();
 	std::map<std::string, Node*> n;
-	mforeach(Node* it, nodes)	
+	foreach(Node* it, nodes)	
 		n[it->getUUID()] = it;
 
 	return n;
@@ -436,7 +480,7 @@ std::map<std::string, Node*> System::getAllNodes()
 std::map<std::string, Edge*> System::getAllEdges()
 {
 	std::map<std::string, Edge*> e;
-	mforeach(Edge* it, edges)	
+	foreach(Edge* it, edges)	
 		e[it->getUUID()] = it;
 
 	return e;
@@ -444,7 +488,7 @@ std::map<std::string, Edge*> System::getAllEdges()
 std::map<std::string, Face*> System::getAllFaces()
 {
 	std::map<std::string, Face*> f;
-	mforeach(Face* it, faces)	
+	foreach(Face* it, faces)	
 		f[it->getUUID()] = it;
 
 	return f;
@@ -501,10 +545,7 @@ System* System::getSubSystem(std::string uuid)
 }
 System* System::getSubSystem(QUuid uuid)
 {
-	if(subsystems.find(uuid)==subsystems.end())
-		return 0;
-
-	return subsystems[uuid];
+	return subsystems.value(uuid, NULL);
 }
 bool System::removeSubSystem(std::string name)
 {
@@ -527,12 +568,15 @@ std::map<std::string, Component*> System::getAllComponentsInView(const DM::View
 }
 std::vector<std::string> System::getUUIDsOfComponentsInView(DM::View view) 
 {
-	std::vector<std::string> names;
-	std::map<std::string, DM::Component*> components_view = this->getAllComponentsInView(view);
-	for (std::map<std::string, DM::Component*>::const_iterator it = components_view.begin(); it != components_view.end(); ++it)
-		names.push_back(it->first);
+	// only names are returned, the components are copied on the first access by name.
+	// The string uuid is not written to components of predecessor states
+	std::set<std::string> sortedNames;
+	DataViewer* dataViewer;
+	if (!view.getName().empty() && map_contains(&dataViewers, view.getName(), dataViewer)) 
+		foreach(Component* c, dataViewer->getComponentsReadOnly())
+			sortedNames.insert(c->getNameUUID().toString().toStdString());
 
-	return names;
+	return std::vector<std::string>(sortedNames.begin(), sortedNames.end());
 }
 
 std::vector<std::string> System::getUUIDs(const DM::View  & view)
@@ -543,7 +587,7 @@ std::vector<std::string> System::getUUIDs(const DM::View  & view)
 std::map<std::string, System*> System::getAllSubSystems()
 {
 	std::map<std::string, System*> syss;
-	mforeach(System* s, subsystems)
+	foreach(System* s, subsystems)
 		syss[s->getUUID()] = s;
 
 	return syss;
@@ -552,7 +596,7 @@ std::map<std::string, System*> System::getAllSubSystems()
 std::map<std::string, RasterData*> System::getAllRasterData()
 {
 	std::map<std::string, RasterData*> rasters;
-	mforeach(RasterData* r, rasterdata)
+	foreach(RasterData* r, rasterdata)
 		rasters[r->getUUID()] = r;
 
 	return rasters;
@@ -623,8 +667,10 @@ bool System::addChild(Component *newcomponent)
 
 	newcomponent->SetOwner(this);
 	// set componentNameMap - if the name is already initialized
-	if(newcomponent->HasAttribute(UUID_ATTRIBUTE_NAME))
-		this->componentNameMap[newcomponent->getAttribute(UUID_ATTRIBUTE_NAME)->getString()] = newcomponent;
+	if(!newcomponent->nameUuid.isNull())
+		this->componentNameMap[newcomponent->nameUuid] = newcomponent;
+	else if(newcomponent->HasAttribute(UUID_ATTRIBUTE_NAME))
+		this->componentNameMap[newcomponent->getNameUUID()] = newcomponent;
 
 	return true;
 }
@@ -640,26 +686,24 @@ bool System::removeChild(Component* c)
 	QMutexLocker ml(mutex);
 
 	QUuid id = c->getQUUID();
-	if(ownedchilds.find(id)==ownedchilds.end())
+	if(!ownedchilds.remove(id))
 		return false;
 
-	ownedchilds.erase(id);
-
 	switch (c->getType())
 	{
-	case COMPONENT: components.erase(id);   break;
-	case NODE:      nodes.erase(id);   break;
-	case FACE:      faces.erase(id);   break;
-	case EDGE:      edges.erase(id);   break;
-	case RASTERDATA: rasterdata.erase(id);   break;
-	case SUBSYSTEM:    subsystems.erase(id);   break;
+	case COMPONENT: components.remove(id);   break;
+	case NODE:      nodes.remove(id);   break;
+	case FACE:      faces.remove(id);   break;
+	case EDGE:      edges.remove(id);   break;
+	case RASTERDATA: rasterdata.remove(id);   break;
+	case SUBSYSTEM:    subsystems.remove(id);   break;
 	}
 
 	mforeach(DataViewer* dataViewer, dataViewers)
 			dataViewer->removeComponent(c);
 
-	if(c->HasAttribute(UUID_ATTRIBUTE_NAME))
-		componentNameMap.erase(c->getUUID());
+	if(!c->nameUuid.isNull())
+		componentNameMap.remove(c->nameUuid);
 
 	delete c;
 	return true;
@@ -669,18 +713,21 @@ bool System::removeChild(QUuid uuid)
 {
 	QMutexLocker ml(mutex);
 
-	if(ownedchilds.find(uuid)==ownedchilds.end())
+	Component *c = ownedchilds.value(uuid, NULL);
+	if(!c)
 		return false;
-	Component *c = ownedchilds[uuid];
 	return removeChild(c);
 }
 
 
 Component* System::getChild(std::string name) const
 {
-	Component *c = NULL;
-	map_contains(&componentNameMap, name, c);
-	return c;
+	return getChildByName(QUuid(QString::fromStdString(name)));
+}
+Component* System::getChildByName(const QUuid& name) const
+{
+	QMutexLocker ml(mutex);
+	return componentNameMap.value(name, NULL);
 }
 
 Component* System::getChild(QUuid uuid) const
@@ -691,23 +738,24 @@ Component* System::getChild(QUuid uuid) const
 }
 Component* System::findChild(QUuid uuid) const
 {
-	if(ownedchilds.find(uuid)==ownedchilds.end())
-		return NULL;
-	return ownedchilds.find(uuid)->second;
+	return ownedchilds.value(uuid, NULL);
 }
 
 std::map<std::string, Component*> System::getAllChilds()
 {
+	MaterializeNodes();
 	std::map<std::string, Component*> resultMap;
-	mforeach(Component* c,ownedchilds)
+	foreach(Component* c,ownedchilds)
 		resultMap[c->getUUID()] = c;
 
 	return resultMap;
 }
 std::vector<Component*> System::getChilds()
 {
+	MaterializeNodes();
 	std::vector<Component*> resultVec;
-	mforeach(Component* c,ownedchilds)
+	resultVec.reserve(ownedchilds.size());
+	foreach(Component* c,ownedchilds)
 		resultVec.push_back(c);
 
 	return resultVec;
@@ -32,6 +32,7 @@
 #include <dmview.h>
 #include <dmcomponent.h>
 #include <dmdataviewer.h>
+#include <dmnodestore.h>
 
 #ifdef SWIG
 #define DM_HELPER_DLL_EXPORT
@@ -71,6 +72,7 @@ class DerivedSystem;
 class  DM_HELPER_DLL_EXPORT System : public Component
 {
 	friend class DerivedSystem;
+	friend class Node;
 public:
 	bool removeChild(Component* c);
 
@@ -113,6 +115,15 @@ public:
 	/** @brief Copies xyz in a new Node, attaches it to the system, returning a pointer*/
 	Node * addNode(const Node &n,  const DM::View & view = DM::View());
 
+	/** @brief Adds nodes without creating Node objects, coordinates holds x, y and z of each node.
+	*
+	* The Node objects are created on the first call of getAllNodes, getAllChilds or getChilds.
+	* Until then the nodes are only accessible via getNodeStore. */
+	void addNodes(const std::vector<double>& coordinates);
+
+	/** @brief Returns the coordinates of all nodes, including the ones without Node object */
+	const NodeStore* getNodeStore() const;
+
 	/** @brief Adds a new Edge to the system, the system class takes ownership of the edge */
 	Edge* addEdge(Edge* edge, const DM::View & view = DM::View());
 
@@ -147,6 +158,10 @@ public:
 	/** @brief Returns a pointer to the face. Returns 0 if Face doesn't exist
 	@deprecated*/
 	virtual Face * getFace(std::string uuid);
+	/** @brief Returns the component with the given name, see Component::getNameUUID. Returns 0 if it doesn't exist.
+	*
+	* Same as getComponent(std::string) without the string uuid, successor states look up their predecessors. */
+	virtual Component* getComponentByName(const QUuid& name);
 
 	/** @brief Removes an Edge. Returns false if the edge doesn't exist
 	@deprecated*/
@@ -246,11 +261,15 @@ public:
 	bool hasChild(const Component* c) const;
 
 	// TODO for faster searching - maybe find a better solution for access
-	std::map<std::string, Component*>	componentNameMap;
+	QHash<QUuid, Component*>	componentNameMap;	// key: Component::getNameUUID
 protected:    
 	/** @brief Returns a pointer to the component. Returns 0 if Component doesn't exist
 	@deprecated*/
 	virtual const Component* getComponentReadOnly(std::string uuid) const;
+	/** @brief Returns the component with the given name, see Component::getNameUUID. Returns 0 if it doesn't exist */
+	virtual const Component* getComponentReadOnlyByName(const QUuid& name) const;
+	/** @brief Makes sure all components of the given type are children of the system, used by DerivedSystem */
+	virtual void LoadChilds(Components type);
 	const Edge* getEdgeReadOnly(Node* start, Node* end);
 private:
 	void SQLInsert();
@@ -262,6 +281,7 @@ private:
 	/*@deprecated*/
 	virtual Component* getChild(std::string name) const;
 	Component* getChild(QUuid uuid) const;
+	Component* getChildByName(const QUuid& name) const;
 	Component* findChild(QUuid uuid) const;
 	/** @brief return table name */
 	QString getTableName();
@@ -270,21 +290,26 @@ private:
 	System* getSubSystem(QUuid uuid);
 	/** @brief add Predecessor **/
 	void addPredecessors(DM::System * s);
+	/** @brief creates the Node objects of all nodes added via addNodes */
+	void MaterializeNodes();
 	
 	//DM::Module* lastModule;
-	std::map<QUuid, Node* >			nodes;
-	std::map<QUuid, Edge* >			edges;
-	std::map<QUuid, Face* >			faces;
-	std::map<QUuid, RasterData *>	rasterdata;
-	std::map<QUuid, System*>		subsystems;
-	std::map<QUuid, Component* >	components;
+	// child indexes, hashed for O(1) inserts and lookups
+	QHash<QUuid, Node* >			nodes;
+	QHash<QUuid, Edge* >			edges;
+	QHash<QUuid, Face* >			faces;
+	QHash<QUuid, RasterData *>		rasterdata;
+	QHash<QUuid, System*>			subsystems;
+	QHash<QUuid, Component* >		components;
 	
 	std::vector<DM::System*> predecessors;
 	std::vector<DM::System*> sucessors;
 
-	std::map<QUuid, Component*>		ownedchilds;
+	QHash<QUuid, Component*>		ownedchilds;
 
 	std::map<std::string, DataViewer*>	dataViewers;
+
+	NodeStore	nodeStore;
 };
 
 typedef std::map<std::string, DM::System*> SystemMap;
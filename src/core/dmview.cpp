@@ -55,16 +55,33 @@ View::View(const View& ref):
 
 View& View::operator=(const View& ref)
 {
+	if(this == &ref)
+		return *this;
 	this->name = ref.name;
 	this->type = ref.type;
 	this->geometryAccess = ref.geometryAccess;
 	this->linkedAttributes = ref.linkedAttributes;
 	this->linkedViews = ref.linkedViews;
+	clearFilters();
 	foreach(DataFilter* f, ref.filters)
 		this->filters.push_back(new DataFilter(*f));
 	return *this;
 }
 
+bool View::operator==(const View& ref) const
+{
+	if(name != ref.name || type != ref.type || geometryAccess != ref.geometryAccess)
+		return false;
+	if(linkedAttributes != ref.linkedAttributes || linkedViews != ref.linkedViews)
+		return false;
+	if(filters.size() != ref.filters.size())
+		return false;
+	for(unsigned int i = 0; i < filters.size(); i++)
+		if(!(*filters[i] == *ref.filters[i]))
+			return false;
+	return true;
+}
+
 View::~View()
 {
 	foreach(DataFilter* f, filters)
@@ -107,6 +107,8 @@ public:
 	~View();
 
 	View& operator= (const View& ref);
+	/** @brief true if name, type, access, attributes, links and filters are the same */
+	bool operator== (const View& ref) const;
 
 	/** @brief add attributes that to write by added by the module*/
 	void addAttribute(std::string name);
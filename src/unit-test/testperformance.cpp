@@ -4,9 +4,29 @@
 #include <dmdbconnector.h>
 #include <dm.h>
 #include <dmcache.h>
+#include <dmattributecodec.h>
 #include <math.h>
 #include <QSqlQuery>
 #include <QElapsedTimer>
+#include <QDir>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <QFutureSynchronizer>
+#include <fstream>
+#include <dmlogsink.h>
+#include <grouptest.h>
+
+//#define SCHEDULER_PROFILING
+//#define BACKEND_PROFILING
+//#define CACHE_CONCURRENCY_PROFILING
+//#define NODESTORE_PROFILING
+//#define SYSTEM_INDEX_PROFILING
+//#define COMPONENT_MUTEX_PROFILING
+//#define ATTRIBUTE_PROFILING
+//#define NAME_LOOKUP_PROFILING
+//#define SUCCESSOR_PROFILING
+//#define COMPACTION_PROFILING
+//#define FILTER_PROFILING
 
 using namespace DM;
 
@@ -195,4 +215,1010 @@ TEST_F(TestPerformance,component_one_attri) {
 }
 #endif
 
+#ifdef SCHEDULER_PROFILING
+
+TEST_F(TestPerformance,scheduler_module_chain) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test scheduler with a long module chain";
+
+    for (long n = 500; n <= 5000; n*=10)
+    {
+        DM::Simulation sim;
+        sim.registerModulesFromDirectory(QDir("./"));
+        DM::Module * last = sim.addModule("TestModule");
+        ASSERT_TRUE(last != 0);
+        for (long i = 1; i < n; i++) {
+            DM::Module * inout = sim.addModule("InOut");
+            ASSERT_TRUE(sim.addLink(last, i == 1 ? "Sewer" : "Inport", inout, "Inport", false));
+            last = inout;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        sim.run();
+        ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+        DM::Logger(Error) << "chain of\t" << n << "\tmodules | " << (long)timer.elapsed() << " ms";
+    }
+}
+
+TEST_F(TestPerformance,scheduler_nested_groups) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test scheduler with deeply nested loop groups";
+
+    for (long depth = 10; depth <= 100; depth*=10)
+    {
+        DM::Simulation sim;
+        sim.registerModulesFromDirectory(QDir("./"));
+        DM::Module * m = sim.addModule("TestModule");
+        ASSERT_TRUE(m != 0);
+
+        // TestModule -> g0 -> g1 -> ... -> gN -> InOut -> gN -> ... -> g0 -> InOut
+        GroupTest* parent = (GroupTest*)sim.addModule("GroupTest");
+        parent->addWriteStream("port");
+        ASSERT_TRUE(sim.addLink(m, "Sewer", parent, "port", false));
+        DM::Module* after = sim.addModule("InOut");
+        ASSERT_TRUE(sim.addLink(parent, "port", after, "Inport", false));
+
+        for (long d = 1; d < depth; d++) {
+            GroupTest* g = (GroupTest*)sim.addModule("GroupTest", parent);
+            g->addWriteStream("port");
+            ASSERT_TRUE(sim.addLink(parent, "port", g, "port", false));
+            ASSERT_TRUE(sim.addLink(g, "port", parent, "port", false));
+            parent = g;
+        }
+        DM::Module* inner = sim.addModule("InOut", parent);
+        ASSERT_TRUE(sim.addLink(parent, "port", inner, "Inport", false));
+        ASSERT_TRUE(sim.addLink(inner, "Inport", parent, "port", false));
+
+        QElapsedTimer timer;
+        timer.start();
+        sim.run();
+        ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+        ASSERT_TRUE(inner->getStatus() == MOD_EXECUTION_OK);
+        ASSERT_TRUE(after->getStatus() == MOD_EXECUTION_OK);
+        DM::Logger(Error) << "group nesting depth\t" << depth << " | " << (long)timer.elapsed() << " ms";
+    }
+}
+
+#endif
+
+#ifdef BACKEND_PROFILING
+
+TEST_F(TestPerformance,backend_node_one_attri) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test storage backends with one attribute per node";
+
+    const char* names[] = {"sqlite file", "sqlite memory", "binary store", "mapped file"};
+    DM::DBBackendType types[] = {DM::SQLITE_FILE, DM::SQLITE_MEMORY, DM::BINARY_STORE, DM::MAPPED_FILE};
+
+    DBConnectorConfig cfg = DBConnector::getInstance()->getConfig();
+    for (int b = 0; b < 4; b++)
+    {
+        DBConnectorConfig cfgNew = cfg;
+        cfgNew.backend = types[b];
+        DBConnector::getInstance()->setConfig(cfgNew);
+
+        for (long n = 1e3; n <= 1e5; n*=10)
+        {
+            DM::System sys;
+            std::vector<DM::Component*> nodes;
+            for (long i = 0; i < n; i++) {
+                DM::Node* node = sys.addNode(0,0,0);
+                node->addAttribute("test", i);
+                nodes.push_back(node);
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            foreach(DM::Component* node, nodes)
+                node->MoveAttributeToDb("test");
+            long writeTime = timer.elapsed();
+
+            timer.restart();
+            for (long i = 0; i < n; i++)
+                ASSERT_TRUE(nodes[i]->getAttribute("test")->getDouble() == i);
+            long readTime = timer.elapsed();
+
+            foreach(DM::Component* node, nodes)
+                node->MoveAttributeToDb("test");
+            timer.restart();
+            DM::Component::LoadAttributes(nodes, "test");
+            long bulkReadTime = timer.elapsed();
+
+            DM::Logger(Error) << names[b] << "\t" << n << "\tnodes | write " << writeTime
+                << " ms | read " << readTime << " ms | bulk read " << bulkReadTime << " ms";
+        }
+    }
+    DBConnector::getInstance()->setConfig(cfg);
+}
+
+TEST_F(TestPerformance,backend_raster_blocks) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test storage backends with raster blocks";
+
+    const char* names[] = {"sqlite file", "sqlite memory", "binary store", "mapped file"};
+    DM::DBBackendType types[] = {DM::SQLITE_FILE, DM::SQLITE_MEMORY, DM::BINARY_STORE, DM::MAPPED_FILE};
+    const long n = 10000;
+    QByteArray block(RASTERBLOCKSIZE*RASTERBLOCKSIZE*sizeof(double), 1);
+
+    DBConnectorConfig cfg = DBConnector::getInstance()->getConfig();
+    for (int b = 0; b < 4; b++)
+    {
+        DBConnectorConfig cfgNew = cfg;
+        cfgNew.backend = types[b];
+        DBConnector::getInstance()->setConfig(cfgNew);
+        DM::DbBackend* backend = DBConnector::getInstance()->getBackend();
+        QUuid owner = QUuid::createUuid();
+
+        QElapsedTimer timer;
+        timer.start();
+        for (long i = 0; i < n; i++)
+            backend->SaveRasterBlock(owner, i, 0, block, false);
+        for (long i = 0; i < n; i++)
+            backend->SaveRasterBlock(owner, i, 0, block, true);
+        long writeTime = timer.elapsed();
+
+        timer.restart();
+        for (long i = 0; i < n; i++)
+            delete backend->LoadRasterBlock(owner, i, 0);
+        long readTime = timer.elapsed();
+
+        DM::Logger(Error) << names[b] << "\t" << n << "\tblocks | insert+update " << writeTime
+            << " ms | read " << readTime << " ms";
+        backend->DeleteRasterField(owner);
+    }
+    DBConnector::getInstance()->setConfig(cfg);
+}
+
+#endif
+
+#ifdef CACHE_CONCURRENCY_PROFILING
+
+// 80% reads, 20% writes on random keys, twice as many keys as the cache holds
+void cacheWorkload(DM::Cache<int,float>* cache, int keys, int operations, unsigned int seed)
+{
+    for (int i = 0; i < operations; i++)
+    {
+        seed = seed*1103515245 + 12345;
+        int key = (seed >> 8) % keys;
+        if ((seed >> 4) % 5 == 0 || !cache->get(key))
+            cache->add(key, new float(key));
+    }
+}
+
+TEST_F(TestPerformance,cache_concurrent_access) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test cache scaling with concurrent threads";
+
+    const int size = 100000;
+    const int operations = 4000000;
+    int maxThreads = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(16);
+
+    for (int threads = 1; threads <= 16; threads*=2)
+    {
+        DM::Cache<int,float> cache(size);
+        QElapsedTimer timer;
+        timer.start();
+        QFutureSynchronizer<void> sync;
+        for (int t = 0; t < threads; t++)
+            sync.addFuture(QtConcurrent::run(cacheWorkload, &cache, 2*size, operations/threads, (unsigned int)t+1));
+        sync.waitForFinished();
+        long elapsed = timer.elapsed();
+
+        DM::Logger(Error) << threads << "\tthreads | " << (int)cache.getShardCount() << " shards | "
+            << elapsed << " ms | " << (double)operations/std::max(elapsed, 1L) << " ops/ms";
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(maxThreads);
+}
+
+#endif
+
+#if defined(NODESTORE_PROFILING) || defined(SUCCESSOR_PROFILING) || defined(COMPACTION_PROFILING)
 
+// resident memory of the process in bytes, 0 if unknown
+long long residentMemory()
+{
+#ifdef __linux__
+    long long pages = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * 4096;
+#else
+    return 0;
+#endif
+}
+
+#endif
+
+#ifdef NODESTORE_PROFILING
+
+TEST_F(TestPerformance,nodestore_memory_per_node) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test memory per node";
+
+    for (long n = 1e5; n <= 1e7; n*=10)
+    {
+        // node objects, skipped for 1e7 as it needs several GB
+        if (n < 1e7)
+        {
+            long long before = residentMemory();
+            DM::System* sys = new DM::System();
+            QElapsedTimer timer;
+            timer.start();
+            for (long i = 0; i < n; i++)
+                sys->addNode(i, i, i);
+            long addTime = timer.elapsed();
+            long long used = residentMemory() - before;
+            DM::Logger(Error) << "addNode\t" << n << "\tnodes | " << addTime << " ms | "
+                << (double)used/n << " bytes/node | node object " << sizeof(DM::Node) << " bytes";
+            delete sys;
+        }
+
+        // columnar nodes without node objects
+        long long before = residentMemory();
+        DM::System* sys = new DM::System();
+        std::vector<double> coordinates(3*n, 1.0);
+        QElapsedTimer timer;
+        timer.start();
+        sys->addNodes(coordinates);
+        long addTime = timer.elapsed();
+        coordinates.clear();
+        std::vector<double>().swap(coordinates);
+        long long used = residentMemory() - before;
+
+        timer.restart();
+        const DM::NodeStore* store = sys->getNodeStore();
+        double sum = 0;
+        for (unsigned int id = 0; id < store->Size(); id++)
+            sum += store->X(id) + store->Y(id) + store->Z(id);
+        long readTime = timer.elapsed();
+        ASSERT_TRUE(sum == 3.0*n);
+
+        DM::Logger(Error) << "addNodes\t" << n << "\tnodes | " << addTime << " ms | "
+            << (double)used/n << " bytes/node | store " << (double)store->GetMemoryUsage()/n
+            << " bytes/node | read xyz " << readTime << " ms";
+        delete sys;
+    }
+}
+
+#endif
+
+#ifdef SYSTEM_INDEX_PROFILING
+
+TEST_F(TestPerformance,system_child_index) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test child indexes: std::map (before) vs QHash (now)";
+
+    for (long n = 1e5; n <= 1e7; n*=10)
+    {
+        std::vector<QUuid> uuids;
+        uuids.reserve(n);
+        for (long i = 0; i < n; i++)
+            uuids.push_back(QUuid::createUuid());
+        DM::Component* dummy = NULL;
+
+        QElapsedTimer timer;
+        timer.start();
+        std::map<QUuid, DM::Component*> tree;
+        foreach (const QUuid& uuid, uuids)
+            tree[uuid] = dummy;
+        long treeInsert = timer.elapsed();
+        timer.restart();
+        long found = 0;
+        foreach (const QUuid& uuid, uuids)
+            found += map_contains(&tree, uuid) ? 1 : 0;
+        long treeLookup = timer.elapsed();
+        ASSERT_TRUE(found == n);
+        tree.clear();
+
+        timer.restart();
+        QHash<QUuid, DM::Component*> hash;
+        foreach (const QUuid& uuid, uuids)
+            hash[uuid] = dummy;
+        long hashInsert = timer.elapsed();
+        timer.restart();
+        found = 0;
+        foreach (const QUuid& uuid, uuids)
+            found += map_contains(&hash, uuid) ? 1 : 0;
+        long hashLookup = timer.elapsed();
+        ASSERT_TRUE(found == n);
+        hash.clear();
+
+        DM::Logger(Error) << n << "\tkeys | std::map insert " << treeInsert << " ms lookup " << treeLookup
+            << " ms | QHash insert " << hashInsert << " ms lookup " << hashLookup << " ms";
+
+        // whole system, node objects for 1e7 need several GB
+        if (n < 1e7)
+        {
+            DM::System sys;
+            std::vector<DM::Node*> nodes;
+            nodes.reserve(n);
+            timer.restart();
+            for (long i = 0; i < n; i++)
+                nodes.push_back(sys.addNode(i, i, i));
+            long insertTime = timer.elapsed();
+            timer.restart();
+            foreach (DM::Node* node, nodes)
+                ASSERT_TRUE(sys.getNode(node->getQUUID()) == node);
+            long lookupTime = timer.elapsed();
+            DM::Logger(Error) << n << "\tnodes | System::addNode " << insertTime
+                << " ms | System::getNode(QUuid) " << lookupTime << " ms";
+        }
+    }
+}
+
+#endif
+
+#if defined(COMPONENT_MUTEX_PROFILING) || defined(NAME_LOOKUP_PROFILING)
+
+#include <new>
+#include <cstdlib>
+
+// counts all heap allocations of the test binary while the benchmarks are compiled in
+static QAtomicInt allocationCount;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    allocationCount.fetchAndAddRelaxed(1);
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    free(p);
+}
+
+#endif
+
+#ifdef COMPONENT_MUTEX_PROFILING
+
+TEST_F(TestPerformance,component_mutex_cost) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test component mutex: allocations and per access cost";
+
+    const int repeat = 10;
+    for (long n = 1e4; n <= 1e6; n*=10)
+    {
+        // before: one recursive mutex per component
+        int allocs = allocationCount;
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<QMutex*> mutexes(n);
+        for (long i = 0; i < n; i++)
+            mutexes[i] = new QMutex(QMutex::Recursive);
+        long mutexTime = timer.elapsed();
+        int mutexAllocs = allocationCount - allocs;
+        for (long i = 0; i < n; i++)
+            delete mutexes[i];
+
+        // now: nodes share the striped mutexes
+        DM::System* sys = new DM::System();
+        std::vector<DM::Node*> nodes(n);
+        allocs = allocationCount;
+        timer.restart();
+        for (long i = 0; i < n; i++)
+            nodes[i] = sys->addNode(i, i, i);
+        long addTime = timer.elapsed();
+        int nodeAllocs = allocationCount - allocs;
+
+        // Node::set locks the node, setX does not
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Node* node, nodes)
+                node->set(r, r, r);
+        double lockedNs = timer.nsecsElapsed() / (double)(n*repeat);
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Node* node, nodes)
+                node->setX(r);
+        double unlockedNs = timer.nsecsElapsed() / (double)(n*repeat);
+
+        DM::Logger(Error) << n << "\tcomponents | per object mutex: " << (double)mutexAllocs/n
+            << " allocs/object " << mutexTime << " ms | addNode: " << (double)nodeAllocs/n
+            << " allocs/node " << addTime << " ms | set (locked) " << lockedNs
+            << " ns | setX (no lock) " << unlockedNs << " ns";
+        delete sys;
+    }
+}
+
+#endif
+
+#ifdef NAME_LOOKUP_PROFILING
+
+TEST_F(TestPerformance,name_lookup_network) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test network in successor states: string uuids (before) vs binary names (now)";
+
+    for (long n = 1e4; n <= 1e6; n*=10)
+    {
+        DM::System* sys = new DM::System();
+        std::vector<DM::Node*> nodes(n+1);
+        std::vector<DM::Edge*> edges(n);
+        int allocs = allocationCount;
+        QElapsedTimer timer;
+        timer.start();
+        for (long i = 0; i <= n; i++)
+            nodes[i] = sys->addNode(i, i, 0);
+        for (long i = 0; i < n; i++)
+            edges[i] = sys->addEdge(nodes[i], nodes[i+1]);
+        long buildTime = timer.elapsed();
+        int buildAllocs = allocationCount - allocs;
+
+        // now: edges and their nodes are copied into the successor by name
+        DM::System* byName = sys->createSuccessor();
+        allocs = allocationCount;
+        timer.restart();
+        foreach (DM::Edge* e, edges)
+            ASSERT_TRUE(byName->getComponentByName(e->getNameUUID()) != NULL);
+        long nameTime = timer.elapsed();
+        int nameAllocs = allocationCount - allocs;
+
+        // before: the same via string uuids, each one is written as attribute on first request
+        DM::System* byString = sys->createSuccessor();
+        allocs = allocationCount;
+        timer.restart();
+        foreach (DM::Edge* e, edges)
+            ASSERT_TRUE(byString->getEdge(e->getUUID()) != NULL);
+        long stringTime = timer.elapsed();
+        int stringAllocs = allocationCount - allocs;
+
+        DM::Logger(Error) << n << "\tedges | build " << (double)buildAllocs/n << " allocs/edge "
+            << buildTime << " ms | successor by string uuid " << (double)stringAllocs/n << " allocs/edge "
+            << stringTime << " ms | successor by name " << (double)nameAllocs/n << " allocs/edge "
+            << nameTime << " ms";
+        delete sys;
+    }
+}
+
+#endif
+
+#ifdef SUCCESSOR_PROFILING
+
+TEST_F(TestPerformance,successor_chain) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test module chain: successor states with read and modify views";
+
+    const int chainLength = 10;
+    for (long n = 1e5; n <= 5e6; n*=50)
+    {
+        DM::System* sys = new DM::System();
+        DM::View view("nodes", DM::NODE, DM::MODIFY);
+        for (long i = 0; i < n; i++)
+        {
+            DM::Node* node = sys->addNode(i, i, i, view);
+            node->addAttribute("value", i);
+        }
+
+        // every module reads the view, every second one modifies the first node
+        DM::System* state = sys;
+        for (int m = 0; m < chainLength; m++)
+        {
+            long long before = residentMemory();
+            QElapsedTimer timer;
+            timer.start();
+            state = state->createSuccessor();
+            bool modify = (m%2 == 1);
+            state->addDataViewer(DM::View("nodes", DM::NODE, modify ? DM::MODIFY : DM::READ));
+            const std::vector<DM::Component*>& nodes = state->getDataViewer("nodes")->getComponents();
+            ASSERT_TRUE((long)nodes.size() == n);
+            if (modify)
+                ((DM::Node*)nodes[0])->setX(-1);
+            long stateTime = timer.elapsed();
+            long long used = residentMemory() - before;
+            DM::Logger(Error) << n << "\tnodes | module " << m << (modify ? " modify " : " read ")
+                << stateTime << " ms | " << (double)used/n << " bytes/node";
+        }
+        delete sys;
+    }
+}
+
+#endif
+
+#ifdef COMPACTION_PROFILING
+
+#include <dmmoduleregistry.h>
+#include <dmnodefactory.h>
+#include <dmgroup.h>
+
+#define COMPACTION_NODES_PER_RUN 1000
+#define COMPACTION_ITERATIONS 200
+
+// creates the nodes of the benchmark
+class CompactionSource: public DM::Module
+{
+    DM_DECLARE_NODE(CompactionSource)
+public:
+    static long nodes;
+    CompactionSource()
+    {
+        std::vector<DM::View> views;
+        views.push_back(DM::View("nodes", DM::NODE, DM::WRITE));
+        addData("city", views);
+    }
+    void run()
+    {
+        DM::System* sys = getData("city");
+        DM::View view("nodes", DM::NODE, DM::WRITE);
+        for (long i = 0; i < nodes; i++)
+            sys->addNode(i, i, 0, view);
+    }
+};
+DM_DECLARE_NODE_NAME(CompactionSource, Modules)
+long CompactionSource::nodes = 0;
+
+// moves another part of the nodes on every run, each run creates a successor state
+class CompactionShifter: public DM::Module
+{
+    DM_DECLARE_NODE(CompactionShifter)
+public:
+    long run_;
+    CompactionShifter(): run_(0)
+    {
+        std::vector<DM::View> views;
+        views.push_back(DM::View("nodes", DM::NODE, DM::MODIFY));
+        addData("city", views);
+        setSuccessorMode(true);
+    }
+    void run()
+    {
+        DM::DataViewer* viewer = getData("city")->getDataViewer("nodes");
+        std::vector<DM::Component*> nodes = viewer->getComponentsReadOnly();
+        // the copies are looked up by name through all predecessor states
+        for (long i = 0; i < COMPACTION_NODES_PER_RUN; i++)
+        {
+            DM::Node* n = (DM::Node*)viewer->getWritable(nodes[(run_*COMPACTION_NODES_PER_RUN + i) % nodes.size()]);
+            n->setZ(n->getZ() + 1);
+        }
+        run_++;
+    }
+};
+DM_DECLARE_NODE_NAME(CompactionShifter, Modules)
+
+// loop group running a fixed number of iterations
+class CompactionLoop: public DM::Group
+{
+    DM_DECLARE_NODE(CompactionLoop)
+public:
+    int runs;
+    CompactionLoop(): runs(0)
+    {
+        addPort("city", INPORT);
+        addPort("city", OUTPORT);
+    }
+    void run(){}
+    void init()
+    {
+        DM::Group::init();
+        runs = 0;
+    }
+private:
+    bool condition()
+    {
+        return runs++ < COMPACTION_ITERATIONS;
+    }
+};
+DM_DECLARE_NODE_NAME(CompactionLoop, Groups)
+
+TEST_F(TestPerformance,successor_compaction_loop) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test loop group: " << COMPACTION_ITERATIONS << " successor states with and without compaction";
+
+    for (long n = 1e5; n <= 1e6; n*=10)
+    {
+        CompactionSource::nodes = n;
+        // 0 disables compaction
+        for (unsigned int limit = 0; limit <= 64; limit = limit ? limit*4 : 16)
+        {
+            long long before = residentMemory();
+            DM::Simulation sim;
+            sim.setSuccessorDepthLimit(limit);
+            sim.getModuleRegistry()->addNodeFactory(new DM::NodeFactory<CompactionSource>());
+            sim.getModuleRegistry()->addNodeFactory(new DM::NodeFactory<CompactionShifter>());
+            sim.getModuleRegistry()->addNodeFactory(new DM::NodeFactory<CompactionLoop>());
+
+            DM::Module* source = sim.addModule("CompactionSource");
+            DM::Module* loop = sim.addModule("CompactionLoop");
+            DM::Module* shifter = sim.addModule("CompactionShifter", loop);
+            ASSERT_TRUE(source && loop && shifter);
+            ASSERT_TRUE(sim.addLink(source, "city", loop, "city", false));
+            ASSERT_TRUE(sim.addLink(loop, "city", shifter, "city", false));
+            ASSERT_TRUE(sim.addLink(shifter, "city", loop, "city", false));
+
+            QElapsedTimer timer;
+            timer.start();
+            sim.run();
+            long elapsed = timer.elapsed();
+            ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+            long long used = residentMemory() - before;
+            DM::Logger(Error) << n << "\tnodes | depth limit " << (long)limit << " | "
+                << elapsed << " ms | " << (double)used/(1024*1024) << " MB";
+        }
+    }
+}
+
+#endif
+
+#ifdef FILTER_PROFILING
+
+#include <dmdatafilter.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+TEST_F(TestPerformance,view_filter) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test view filters on 5M nodes by coordinate and attribute";
+
+    const long n = 5e6;
+    DM::System sys;
+    DM::View view("nodes", DM::NODE, DM::READ);
+    view.addAttribute("value");
+    for (long i = 0; i < n; i++)
+    {
+        DM::Node* node = sys.addNode(i, i%1000, 0, view);
+        node->addAttribute("value", i%10);
+    }
+
+    std::vector<std::string> names;
+    std::vector<DM::View> filtered;
+    DM::View v = view;
+    v.addFilter(DM::DataFilter(DM::DataFilter::X, DM::DataFilter::LESS, n/2));
+    names.push_back("x < n/2");
+    filtered.push_back(v);
+    v = view;
+    v.addFilter(DM::DataFilter("value", DM::DataFilter::GREATEREQUAL, 5.0));
+    names.push_back("value >= 5");
+    filtered.push_back(v);
+    v = view;
+    v.addFilter(DM::DataFilter(DM::DataFilter::X, DM::DataFilter::LESS, n/2));
+    v.addFilter(DM::DataFilter("value", DM::DataFilter::GREATEREQUAL, 5.0));
+    names.push_back("x < n/2 and value >= 5");
+    filtered.push_back(v);
+    v = view;
+    v.addFilter(DM::DataFilter(DM::DataFilter::Y, DM::DataFilter::LESS, 100));
+    v.addFilter(DM::DataFilter("value", DM::DataFilter::EQUAL, 0.0, DM::DataFilter::OR));
+    names.push_back("y < 100 or value == 0");
+    filtered.push_back(v);
+
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+    for (int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? maxThreads : threads+1)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+        for (unsigned int i = 0; i < filtered.size(); i++)
+        {
+            // without filters first, so the filters are applied to all nodes
+            sys.addDataViewer(view);
+            QElapsedTimer timer;
+            timer.start();
+            sys.addDataViewer(filtered[i]);
+            long elapsed = timer.elapsed();
+            long count = sys.getDataViewer("nodes")->getComponentsReadOnly().size();
+            DM::Logger(Error) << names[i] << "\t| " << threads << " threads | "
+                << elapsed << " ms | " << count << " nodes passed";
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
+
+#endif
+
+#ifdef ATTRIBUTE_PROFILING
+
+TEST_F(TestPerformance,attribute_access) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test attribute access by name and by id";
+
+    const long n = 1e5;
+    const int repeat = 10;
+    for (int attributes = 5; attributes <= 20; attributes += 5)
+    {
+        std::vector<std::string> names;
+        std::vector<DM::AttributeId> ids;
+        for (int a = 0; a < attributes; a++)
+        {
+            names.push_back(QString("attribute_%1").arg(a).toStdString());
+            ids.push_back(DM::AttributeNames::GetId(names.back()));
+        }
+
+        DM::System sys;
+        std::vector<DM::Node*> nodes(n);
+        QElapsedTimer timer;
+        timer.start();
+        for (long i = 0; i < n; i++)
+        {
+            nodes[i] = sys.addNode(i, i, i);
+            for (int a = 0; a < attributes; a++)
+                nodes[i]->addAttribute(names[a], a);
+        }
+        long addTime = timer.elapsed();
+
+        double sum = 0;
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Node* node, nodes)
+                for (int a = 0; a < attributes; a++)
+                    sum += node->getAttribute(names[a])->getDouble();
+        double nameNs = timer.nsecsElapsed() / (double)(n*repeat*attributes);
+
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Node* node, nodes)
+                for (int a = 0; a < attributes; a++)
+                    sum += node->getAttribute(ids[a])->getDouble();
+        double idNs = timer.nsecsElapsed() / (double)(n*repeat*attributes);
+        ASSERT_TRUE(sum > 0);
+
+        DM::Logger(Error) << attributes << "\tattributes | add " << addTime << " ms | by name "
+            << nameNs << " ns | by id " << idNs << " ns";
+    }
+}
+
+TEST_F(TestPerformance,attribute_values) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test add and change attribute workloads, sizeof(AttributeValue) = "
+        << (int)sizeof(DM::Attribute::AttributeValue);
+
+    const int repeat = 10;
+    for (long n = 1e4; n <= 1e6; n*=10)
+    {
+        std::vector<DM::Component*> components(n);
+        for (long i = 0; i < n; i++)
+            components[i] = new DM::Component();
+
+        QElapsedTimer timer;
+        timer.start();
+        foreach (DM::Component* c, components)
+        {
+            c->addAttribute("value", 1.0);
+            c->addAttribute("name", "short");
+        }
+        long addTime = timer.elapsed();
+
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Component* c, components)
+                c->changeAttribute("value", r);
+        long changeDoubleTime = timer.elapsed();
+
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+            foreach (DM::Component* c, components)
+                c->changeAttribute("name", r%2 ? "odd" : "even");
+        long changeStringTime = timer.elapsed();
+
+        std::vector<double> vector(100, 1.0);
+        foreach (DM::Component* c, components)
+            c->getAttribute("vector")->setDoubleVector(vector);
+        timer.restart();
+        std::vector<DM::Component*> copies(n);
+        for (long i = 0; i < n; i++)
+            copies[i] = components[i]->clone();
+        long copyTime = timer.elapsed();
+
+        DM::Logger(Error) << n << "\tcomponents | add " << addTime << " ms | change double "
+            << changeDoubleTime << " ms | change string " << changeStringTime
+            << " ms | copy with vector " << copyTime << " ms";
+
+        for (long i = 0; i < n; i++)
+        {
+            delete copies[i];
+            delete components[i];
+        }
+    }
+}
+
+// previous QDataStream based format, reference for the codec
+static QByteArray streamEncode(const std::vector<double>& v)
+{
+    QByteArray bytes;
+    QDataStream s(&bytes, QIODevice::WriteOnly);
+    s << QVector<double>::fromStdVector(v);
+    return bytes;
+}
+
+static std::vector<double> streamDecodeDoubles(const QByteArray& bytes)
+{
+    QDataStream s(bytes);
+    QVector<double> v;
+    s >> v;
+    return v.toStdVector();
+}
+
+static QByteArray streamEncode(const DM::TimeSeriesAttribute& a)
+{
+    QByteArray bytes;
+    QDataStream s(&bytes, QIODevice::WriteOnly);
+    int size = a.timestamp.size();
+    s << size;
+    for (int i = 0; i < size; i++)
+    {
+        s << QString::fromStdString(a.timestamp[i]);
+        s << a.value[i];
+    }
+    return bytes;
+}
+
+static DM::TimeSeriesAttribute streamDecodeTimeSeries(const QByteArray& bytes)
+{
+    QDataStream s(bytes);
+    DM::TimeSeriesAttribute ts;
+    int size;
+    s >> size;
+    for (int i = 0; i < size; i++)
+    {
+        QString str;
+        double d;
+        s >> str >> d;
+        ts.timestamp.push_back(str.toStdString());
+        ts.value.push_back(d);
+    }
+    return ts;
+}
+
+TEST_F(TestPerformance,attribute_codec) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test attribute encoding round trip: QDataStream vs AttributeCodec";
+
+    const int repeat = 20;
+    for (int n = 1e3; n <= 1e6; n*=10)
+    {
+        std::vector<double> vector(n);
+        DM::TimeSeriesAttribute ts;
+        for (int i = 0; i < n; i++)
+        {
+            vector[i] = i*0.25;
+            ts.timestamp.push_back(QString("2012-01-01 %1:%2:00").arg(i/60%24).arg(i%60).toStdString());
+            ts.value.push_back(i%10);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        int streamSize = 0;
+        for (int r = 0; r < repeat; r++)
+        {
+            QByteArray bytes = streamEncode(vector);
+            streamSize = bytes.size();
+            ASSERT_TRUE(streamDecodeDoubles(bytes).size() == (size_t)n);
+        }
+        double streamVector = timer.nsecsElapsed() / 1e6 / repeat;
+
+        timer.restart();
+        int codecSize = 0;
+        for (int r = 0; r < repeat; r++)
+        {
+            QByteArray bytes = DM::AttributeCodec::Encode(vector);
+            codecSize = bytes.size();
+            std::vector<double> result;
+            ASSERT_TRUE(DM::AttributeCodec::Decode(bytes, &result) && result.size() == (size_t)n);
+        }
+        double codecVector = timer.nsecsElapsed() / 1e6 / repeat;
+
+        DM::Logger(Error) << n << "\tdoubles | QDataStream " << streamVector << " ms " << streamSize
+            << " bytes | codec " << codecVector << " ms " << codecSize << " bytes";
+
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+        {
+            QByteArray bytes = streamEncode(ts);
+            streamSize = bytes.size();
+            ASSERT_TRUE(streamDecodeTimeSeries(bytes).value.size() == (size_t)n);
+        }
+        double streamTs = timer.nsecsElapsed() / 1e6 / repeat;
+
+        timer.restart();
+        for (int r = 0; r < repeat; r++)
+        {
+            QByteArray bytes = DM::AttributeCodec::Encode(ts);
+            codecSize = bytes.size();
+            DM::TimeSeriesAttribute result;
+            ASSERT_TRUE(DM::AttributeCodec::Decode(bytes, &result) && result.value.size() == (size_t)n);
+        }
+        double codecTs = timer.nsecsElapsed() / 1e6 / repeat;
+
+        DM::Logger(Error) << n << "\ttime series entries | QDataStream " << streamTs << " ms " << streamSize
+            << " bytes | codec " << codecTs << " ms " << codecSize << " bytes";
+    }
+}
+
+TEST_F(TestPerformance,timeseries_access) {
+
+    ostream *out = &cout;
+    DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+    DM::Logger(DM::Error) << "Test reading 8760 step time series: string series copy vs numeric series span";
+
+    const int steps = 8760;
+    const int nodes = 1000;
+    std::vector<std::string> timestamps;
+    std::vector<double> times, values;
+    for (int i = 0; i < steps; i++)
+    {
+        times.push_back(1325376000.0 + i*3600);
+        values.push_back(i%24);
+        timestamps.push_back(QString::number(times.back(), 'f', 0).toStdString());
+    }
+
+    std::vector<DM::Attribute*> stringSeries, numericSeries;
+    for (int n = 0; n < nodes; n++)
+    {
+        stringSeries.push_back(new DM::Attribute("flow"));
+        stringSeries.back()->addTimeSeries(timestamps, values);
+        numericSeries.push_back(new DM::Attribute("flow"));
+        numericSeries.back()->setTimeSeries(times, values);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    double sum = 0;
+    foreach (DM::Attribute* a, stringSeries)
+    {
+        std::vector<std::string> t;
+        std::vector<double> v;
+        a->getTimeSeries(&t, &v);
+        for (int i = 0; i < steps; i++)
+            sum += v[i];
+    }
+    long copyTime = timer.elapsed();
+
+    timer.restart();
+    double spanSum = 0;
+    foreach (DM::Attribute* a, numericSeries)
+    {
+        DM::TimeSeriesSpan span = a->getTimeSeriesSpan();
+        const double* v = span.valueData();
+        for (size_t i = 0; i < span.size(); i++)
+            spanSum += v[i];
+    }
+    long spanTime = timer.elapsed();
+    ASSERT_DOUBLE_EQ(sum, spanSum);
+
+    DM::Logger(Error) << nodes << " series | getTimeSeries copy " << copyTime
+        << " ms | getTimeSeriesSpan " << spanTime << " ms";
+
+    for (int n = 0; n < nodes; n++)
+    {
+        delete stringSeries[n];
+        delete numericSeries[n];
+    }
+}
+
+#endif
@@ -183,6 +183,113 @@ TEST_F(TestSimulation,linkedModulesTest) {
 	ASSERT_TRUE(inout->getStatus() == MOD_EXECUTION_OK);
 }
 
+TEST_F(TestSimulation,parallelBranchesTest) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test Parallel Branches";
+	DM::Simulation sim;
+	sim.registerModulesFromDirectory(QDir("./"));;
+	sim.setParallelExecution(true);
+	ASSERT_TRUE(sim.isParallelExecution());
+
+	// two independent chains and one branching chain
+	std::vector<DM::Module*> mods;
+	for (int i = 0; i < 2; i++) {
+		DM::Module * m = sim.addModule("TestModule");
+		ASSERT_TRUE(m != 0);
+		DM::Module * inout  = sim.addModule("InOut");
+		ASSERT_TRUE(inout != 0);
+		DM::Module * inout2  = sim.addModule("InOut");
+		ASSERT_TRUE(inout2 != 0);
+		ASSERT_TRUE(sim.addLink(m, "Sewer", inout, "Inport"));
+		ASSERT_TRUE(sim.addLink(inout, "Inport", inout2, "Inport"));
+		mods.push_back(m);
+		mods.push_back(inout);
+		mods.push_back(inout2);
+	}
+	DM::Module * m = sim.addModule("TestModule");
+	ASSERT_TRUE(m != 0);
+	mods.push_back(m);
+	for (int i = 0; i < 2; i++) {
+		DM::Module * inout  = sim.addModule("InOut");
+		ASSERT_TRUE(inout != 0);
+		ASSERT_TRUE(sim.addLink(m, "Sewer", inout, "Inport"));
+		mods.push_back(inout);
+	}
+
+	for (long i = 0; i < 10; i++){
+		sim.run();
+		ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	}
+	foreach(DM::Module* m, mods)
+		ASSERT_TRUE(m->getStatus() == MOD_EXECUTION_OK);
+}
+
+TEST_F(TestSimulation,incrementalStreamCheck) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test Incremental Stream Check";
+	DM::Simulation sim;
+	sim.registerModulesFromDirectory(QDir("./"));;
+	DM::Module * m = sim.addModule("TestModule");
+	ASSERT_TRUE(m != 0);
+	DM::Module * inout  = sim.addModule("InOut");
+	ASSERT_TRUE(inout != 0);
+	ASSERT_TRUE(sim.addLink(m, "Sewer", inout, "Inport", false));
+
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 2);
+
+	// nothing changed
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 0);
+
+	// only the downstream cone of the new link
+	DM::Module * inout2  = sim.addModule("InOut");
+	ASSERT_TRUE(inout2 != 0);
+	ASSERT_TRUE(sim.addLink(inout, "Inport", inout2, "Inport", false));
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 2);
+	ASSERT_TRUE(inout2->getStatus() == MOD_EXECUTION_OK);
+
+	// parameter changes revalidate the module and its successors
+	inout2->setParameterValue("a", "7");
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 1);
+}
+
+TEST_F(TestSimulation,incrementalStreamCheckInitData) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test Incremental Stream Check with data declared in init";
+	DM::Simulation sim;
+	sim.registerModulesFromDirectory(QDir("./"));;
+	DM::Module * m = sim.addModule("TestModule");
+	ASSERT_TRUE(m != 0);
+	DM::Module * initdata  = sim.addModule("InitData");
+	ASSERT_TRUE(initdata != 0);
+	DM::Module * inout  = sim.addModule("InOut");
+	ASSERT_TRUE(inout != 0);
+	ASSERT_TRUE(sim.addLink(m, "Sewer", initdata, "Inport", false));
+	ASSERT_TRUE(sim.addLink(initdata, "Inport", inout, "Inport", false));
+
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 3);
+
+	// declaring the same views again in init is no change
+	for(int i = 0; i < 3; i++)
+	{
+		sim.run();
+		ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+		ASSERT_TRUE(sim.getRevalidatedModuleCount() == 0);
+	}
+}
+
 TEST_F(TestSimulation,linkedDynamicModules) {
 	ostream *out = &cout;
 	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
@@ -276,6 +383,40 @@ TEST_F(TestSimulation,LoopGroupTest)
 	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);*/
 
 }
+
+TEST_F(TestSimulation,repeatedGroupRunTest)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test running a group twice";
+	DM::Simulation sim;
+	sim.registerModulesFromDirectory(QDir("./"));;
+
+	DM::Module* m = sim.addModule("TestModule");
+	ASSERT_TRUE(m != 0);
+
+	GroupTest* g = (GroupTest* ) sim.addModule("GroupTest");
+	ASSERT_TRUE(g != 0);
+	g->addWriteStream("port");
+
+	DM::Module* inoutInGroup  = sim.addModule("InOut", g);
+	ASSERT_TRUE(inoutInGroup != 0);
+
+	ASSERT_TRUE(sim.addLink(m, "Sewer", g, "port"));
+	ASSERT_TRUE(sim.addLink(g, "port", inoutInGroup, "Inport"));
+	ASSERT_TRUE(sim.addLink(inoutInGroup, "Inport", g, "port"));
+
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(inoutInGroup->getStatus() == MOD_EXECUTION_OK);
+
+	// nothing changed, the group is not revalidated but has to run again
+	sim.run();
+	ASSERT_TRUE(sim.getSimulationStatus() == DM::SIM_OK);
+	ASSERT_TRUE(sim.getRevalidatedModuleCount() == 0);
+	ASSERT_TRUE(g->getStatus() == MOD_EXECUTION_OK);
+	ASSERT_TRUE(inoutInGroup->getStatus() == MOD_EXECUTION_OK);
+}
 #define GROUPTEST
 #ifdef GROUPTEST
 
@@ -30,13 +30,18 @@
 #include <dmsimulation.h>
 #include <dmdbconnector.h>
 #include <dmcache.h>
+#include <dmattributecodec.h>
 #include <createallcomponents.h>
 #include <dmlogsink.h>
 #include <dmview.h>
+#include <dmderivedsystem.h>
+#include <dmdataviewer.h>
 #include "dmdatafilter.h"
 
 
 #include <QSqlQuery>
+#include <QtConcurrentRun>
+#include <QFutureSynchronizer>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -247,6 +252,167 @@ TEST_F(TestSystem,cachetest) {
 	DBConnector::getInstance()->setConfig(cfg);
 }
 
+void fillCache(Cache<int,float>* c, int first, int n)
+{
+	for(int i=first;i<first+n;i++)
+		c->add(i, new float(i));
+	for(int i=first;i<first+n;i++)
+		c->get(i);
+}
+
+TEST_F(TestSystem,cacheConcurrent) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test cache with concurrent access";
+
+	const int threads = 8;
+	const int n = 10000;
+
+	// infinite cache: nothing may get lost
+	Cache<int,float> c(0);
+	ASSERT_TRUE(c.getShardCount() == CACHE_SHARDS);
+	QFutureSynchronizer<void> sync;
+	for(int t=0;t<threads;t++)
+		sync.addFuture(QtConcurrent::run(fillCache, &c, t*n, n));
+	sync.waitForFinished();
+
+	for(int i=0;i<threads*n;i++)
+	{
+		float* v = c.get(i);
+		ASSERT_TRUE(v != NULL);
+		ASSERT_TRUE(*v == i);
+	}
+
+	// limited cache: elements are dropped, the remaining ones have to stay consistent
+	Cache<int,float> limited(threads*n/4);
+	ASSERT_TRUE(limited.getShardCount() > 1);
+	for(int t=0;t<threads;t++)
+		sync.addFuture(QtConcurrent::run(fillCache, &limited, t*n, n));
+	sync.waitForFinished();
+
+	int found = 0;
+	for(int i=0;i<threads*n;i++)
+	{
+		float* v = limited.get(i);
+		if(v)
+		{
+			ASSERT_TRUE(*v == i);
+			found++;
+		}
+	}
+	ASSERT_TRUE(found > 0);
+	ASSERT_TRUE((unsigned long)found <= limited.getSize() + limited.getShardCount());
+}
+
+// hot keys survive a scan over many other keys, only with CACHE_2Q
+int hotKeysAfterScan(CachePolicy policy)
+{
+	const int size = 100;
+	Cache<int,float> c(size, policy);
+	// two rounds: keys coming back after being dropped become frequent ones
+	for(int round=0;round<2;round++)
+	{
+		for(int i=0;i<size/2;i++)
+			if(!c.get(i))
+				c.add(i, new float(i));
+		for(int i=1000*(round+1);i<1000*(round+1)+size;i++)
+			c.add(i, new float(i));
+	}
+	for(int i=0;i<size/2;i++)
+		if(!c.get(i))
+			c.add(i, new float(i));
+	// scan
+	for(int i=10000;i<10000+10*size;i++)
+		if(!c.get(i))
+			c.add(i, new float(i));
+
+	int hot = 0;
+	for(int i=0;i<size/2;i++)
+		if(c.get(i))
+			hot++;
+	return hot;
+}
+
+TEST_F(TestSystem,cachePolicies) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test cache eviction policies";
+
+	CacheStatistics::Reset();
+	ASSERT_TRUE(hotKeysAfterScan(CACHE_LRU) == 0);
+	ASSERT_TRUE(hotKeysAfterScan(CACHE_2Q) == 50);
+
+	// basic operations with CACHE_2Q
+	Cache<int,float> c(3, CACHE_2Q);
+	c.add(1, new float(1));
+	ASSERT_TRUE(c.get(1) != NULL);
+	c.remove(1);
+	ASSERT_TRUE(c.get(1) == NULL);
+	ASSERT_TRUE(c.replace(1, new float(1)) == false);
+
+#ifdef CACHE_PROFILING
+	c.ReportProfilingCounters();
+	ASSERT_TRUE(CacheStatistics::GetHits(CACHE_2Q) > CacheStatistics::GetHits(CACHE_LRU));
+	CacheStatistics::Print();
+#endif
+}
+
+TEST_F(TestSystem,cacheMemoryBudget) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test cache memory budget";
+
+	const qint64 blockSize = 64*1024;
+	const qint64 budget = 4*1024*1024;
+	qint64 usedBefore = CacheBudget::GetUsedBytes();
+
+	DBConnectorConfig cfg = DBConnector::getInstance()->getConfig();
+	DBConnectorConfig cfgNew = cfg;
+	cfgNew.cacheMemoryBudget = budget;
+	DBConnector::getInstance()->setConfig(cfgNew);
+	ASSERT_TRUE(DBConnector::getInstance()->getConfig().cacheMemoryBudget == budget);
+	{
+		// two caches share the budget, each element is accounted with its size
+		Cache<int,QByteArray> a(0);
+		Cache<int,QByteArray> b(0);
+		for(int i=0;i<200;i++)
+		{
+			a.add(i, new QByteArray(blockSize, 1));
+			b.add(i, new QByteArray(blockSize, 2));
+		}
+		qint64 used = CacheBudget::GetUsedBytes() - usedBefore;
+		ASSERT_TRUE(used > budget/2);
+		// every shard keeps at least its newest element
+		ASSERT_TRUE(used <= budget + (a.getShardCount()+b.getShardCount())*2*blockSize);
+
+		// the newest elements are kept
+		ASSERT_TRUE(a.get(199) != NULL);
+		ASSERT_TRUE(b.get(199) != NULL);
+		ASSERT_TRUE(a.get(0) == NULL);
+	}
+	{
+		// a small cache within its share is not emptied by a large one exceeding the budget
+		Cache<int,QByteArray> a(0);
+		Cache<int,QByteArray> b(100);
+		for(int i=0;i<200;i++)
+			a.add(i, new QByteArray(blockSize, 1));
+		for(int i=0;i<10;i++)
+		{
+			a.add(200+i, new QByteArray(blockSize, 1));
+			b.add(i, new QByteArray(1024, 2));
+		}
+		ASSERT_TRUE(CacheBudget::GetShareBytes() > 10*2048);
+		for(int i=0;i<10;i++)
+			ASSERT_TRUE(b.get(i) != NULL);
+	}
+	ASSERT_TRUE(CacheBudget::GetUsedBytes() == usedBefore);
+
+	// limits below a kilobyte are not unlimited
+	CacheBudget::SetLimit(1);
+	ASSERT_TRUE(CacheBudget::GetLimit() == 1024);
+	DBConnector::getInstance()->setConfig(cfg);
+}
+
 TEST_F(TestSystem,simplesqltest) {
 	ostream *out = &cout;
 	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
@@ -660,6 +826,25 @@ TEST_F(TestSystem, SQLattributes)
 		delete c;
 	}
 
+	DM::Logger(DM::Standard) << "Test bulk attribute loading";
+	{
+		// more components than fit into one select block
+		std::vector<DM::Component*> components;
+		for(int i=0;i<250;i++)
+		{
+			DM::Component* c = new DM::Component;
+			c->addAttribute("bulk", i);
+			c->MoveAttributeToDb("bulk");
+			components.push_back(c);
+		}
+		DM::Component::LoadAttributes(components, "bulk");
+		for(int i=0;i<250;i++)
+		{
+			ASSERT_TRUE(components[i]->getAttribute("bulk")->getDouble() == i);
+			delete components[i];
+		}
+	}
+
 
 	DM::Logger(DM::Debug) << "checking add attributes";
 	// DOUBLE
@@ -771,6 +956,94 @@ TEST_F(TestSystem, SQLattributes)
 	// print cache statistics
 //	DM::Attribute::PrintCacheStatistics();
 }
+TEST_F(TestSystem, BinaryStoreBackend)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test binary store backends";
+
+	DBConnectorConfig cfg = DBConnector::getInstance()->getConfig();
+	DM::DBBackendType types[] = {DM::BINARY_STORE, DM::MAPPED_FILE};
+	for(int b=0;b<2;b++)
+	{
+		DBConnectorConfig cfgNew = cfg;
+		cfgNew.backend = types[b];
+		DBConnector::getInstance()->setConfig(cfgNew);
+		ASSERT_FALSE(DBConnector::getInstance()->getBackend()->IsSql());
+
+		// attributes
+		std::vector<DM::Component*> components;
+		for(int i=0;i<10;i++)
+		{
+			DM::Component* c = new DM::Component;
+			c->addAttribute("value", i);
+			c->addAttribute("name", "component");
+			c->MoveAttributeToDb("value");
+			c->MoveAttributeToDb("name");
+			components.push_back(c);
+		}
+		for(int i=0;i<10;i++)
+		{
+			ASSERT_TRUE(components[i]->getAttribute("value")->getDouble() == i);
+			ASSERT_TRUE(components[i]->getAttribute("name")->getString() == "component");
+			// update
+			components[i]->changeAttribute("value", i+10);
+			components[i]->MoveAttributeToDb("value");
+		}
+		DM::Component::LoadAttributes(components, "value");
+		for(int i=0;i<10;i++)
+		{
+			ASSERT_TRUE(components[i]->getAttribute("value")->getDouble() == i+10);
+			delete components[i];
+		}
+
+		// raster blocks
+		DM::DbBackend* backend = DBConnector::getInstance()->getBackend();
+		QUuid owner = QUuid::createUuid();
+		backend->SaveRasterBlock(owner, 1, 2, QByteArray("block"), false);
+		backend->SaveRasterBlock(owner, 1, 2, QByteArray("changed"), true);
+		QByteArray* block = backend->LoadRasterBlock(owner, 1, 2);
+		ASSERT_TRUE(block != NULL && *block == QByteArray("changed"));
+		delete block;
+		backend->DeleteRasterField(owner);
+		ASSERT_TRUE(backend->LoadRasterBlock(owner, 1, 2) == NULL);
+	}
+	DBConnector::getInstance()->setConfig(cfg);
+	ASSERT_TRUE(DBConnector::getInstance()->getBackend()->IsSql());
+}
+
+TEST_F(TestSystem, BinaryStoreCompaction)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test binary store compaction";
+
+	DM::BinaryBackend backend(true);
+	ASSERT_TRUE(backend.Open());
+
+	// overwrite the same blocks over and over, so full segments turn into garbage
+	QUuid owner = QUuid::createUuid();
+	const int blocks = 16;
+	QByteArray data(RASTERBLOCKSIZE*RASTERBLOCKSIZE*sizeof(double), 0);
+	for(int round=0;round<100;round++)
+	{
+		data.fill((char)round);
+		for(int y=0;y<blocks;y++)
+			backend.SaveRasterBlock(owner, 0, y, data, round > 0);
+	}
+	backend.WaitForCompaction();
+
+	// the live data fits into two segments, everything else has to be compacted
+	ASSERT_TRUE(backend.GetStoredBytes() <= 3*BINARYSTORE_SEGMENT_SIZE);
+	for(int y=0;y<blocks;y++)
+	{
+		QByteArray* block = backend.LoadRasterBlock(owner, 0, y);
+		ASSERT_TRUE(block != NULL && *block == data);
+		delete block;
+	}
+	backend.Close();
+}
+
 TEST_F(TestSystem, SystemGetEdge)
 {
 	ostream *out = &cout;
@@ -785,6 +1058,487 @@ TEST_F(TestSystem, SystemGetEdge)
 	ASSERT_TRUE(e==sys.getEdge(n0->getUUID(), n1->getUUID()));
 }
 
+TEST_F(TestSystem, NodeStore)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test node store";
+
+	System sys;
+	// nodes added via addNode live in the store
+	Node* n0 = sys.addNode(1,2,3);
+	const NodeStore* store = sys.getNodeStore();
+	ASSERT_TRUE(store->Count() == 1);
+	n0->setX(10);
+	ASSERT_TRUE(store->X(0) == 10);
+	ASSERT_TRUE(n0->getY() == 2);
+
+	// copies are detached
+	Node copy(*n0);
+	copy.setX(20);
+	ASSERT_TRUE(n0->getX() == 10);
+
+	// lazy nodes are materialized on access
+	std::vector<double> coordinates;
+	for(int i=0;i<3000;i++)
+		coordinates.push_back(i);
+	sys.addNodes(coordinates);
+	ASSERT_TRUE(store->Count() == 1001);
+	ASSERT_TRUE(store->LazyCount() == 1000);
+	ASSERT_TRUE(store->Y(1000) == 2998);
+
+	std::map<std::string, Node*> nodes = sys.getAllNodes();
+	ASSERT_TRUE(nodes.size() == 1001);
+	ASSERT_TRUE(store->LazyCount() == 0);
+	mforeach(Node* n, nodes)
+		if(n != n0)
+			ASSERT_TRUE(n->getY() == n->getX()+1 && n->getZ() == n->getX()+2);
+
+	// removed nodes free their slot
+	sys.removeNode(n0->getUUID());
+	ASSERT_TRUE(store->Count() == 1000);
+	Node* n1 = sys.addNode(copy);
+	ASSERT_TRUE(store->Count() == 1001);
+	ASSERT_TRUE(n1->getX() == 20 && n1->getZ() == 3);
+}
+
+TEST_F(TestSystem, AttributeIds)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test interned attribute names";
+
+	AttributeId length = AttributeNames::GetId("length");
+	ASSERT_TRUE(AttributeNames::GetId("length") == length);
+	ASSERT_TRUE(AttributeNames::GetName(length) == "length");
+	AttributeId unknown;
+	ASSERT_FALSE(AttributeNames::FindId("never used attribute name", &unknown));
+
+	// string and id access refer to the same attribute
+	Component c;
+	c.addAttribute("length", 5);
+	ASSERT_TRUE(c.getAttribute(length) == c.getAttribute("length"));
+	ASSERT_TRUE(c.getAttribute(length)->getNameId() == length);
+	ASSERT_DOUBLE_EQ(c.getAttribute(length)->getDouble(), 5);
+
+	// more attributes than stored inline
+	for(int i=0;i<3*ATTRIBUTELIST_INLINE_SIZE;i++)
+		c.addAttribute(QString("a%1").arg(i).toStdString(), i);
+	for(int i=0;i<3*ATTRIBUTELIST_INLINE_SIZE;i++)
+		ASSERT_DOUBLE_EQ(c.getAttribute(QString("a%1").arg(i).toStdString())->getDouble(), i);
+	ASSERT_TRUE(c.getAllAttributes().size() == 3*ATTRIBUTELIST_INLINE_SIZE + 1);
+
+	ASSERT_TRUE(c.removeAttribute("a0"));
+	ASSERT_FALSE(c.removeAttribute("a0"));
+	ASSERT_TRUE(c.getAllAttributes().size() == 3*ATTRIBUTELIST_INLINE_SIZE);
+	ASSERT_DOUBLE_EQ(c.getAttribute("a1")->getDouble(), 1);
+
+	// copies own their attributes
+	Component copy(c);
+	copy.getAttribute(length)->setDouble(6);
+	ASSERT_DOUBLE_EQ(c.getAttribute(length)->getDouble(), 5);
+}
+
+TEST_F(TestSystem, AttributeValues)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test inline and shared attribute values";
+
+	std::string shortString(ATTRIBUTEVALUE_INLINE_STRING, 's');
+	std::string longString(ATTRIBUTEVALUE_INLINE_STRING + 1, 'l');
+
+	Attribute a("a");
+	a.setString(shortString);
+	ASSERT_TRUE(a.getString() == shortString);
+	a.setString(longString);
+	ASSERT_TRUE(a.getString() == longString);
+	a.setString("");
+	ASSERT_TRUE(a.getString() == "" && a.getType() == Attribute::STRING);
+	a.setDouble(3.5);
+	ASSERT_DOUBLE_EQ(a.getDouble(), 3.5);
+	ASSERT_TRUE(a.getString() == "");
+
+	// copies share vectors until one of them is changed
+	std::vector<double> v(1000, 1.0);
+	a.setDoubleVector(v);
+	Attribute b(a);
+	Attribute c("c");
+	c.Change(a);
+	v[0] = 2.0;
+	b.setDoubleVector(v);
+	ASSERT_DOUBLE_EQ(a.getDoubleVector()[0], 1.0);
+	ASSERT_DOUBLE_EQ(b.getDoubleVector()[0], 2.0);
+	ASSERT_DOUBLE_EQ(c.getDoubleVector()[0], 1.0);
+	a.setType(Attribute::NOTYPE);
+	ASSERT_TRUE(c.getDoubleVector().size() == 1000);
+
+	c.setString(longString);
+	Attribute d("d");
+	d = c;
+	c.setString(shortString);
+	ASSERT_TRUE(d.getString() == longString);
+
+	std::vector<std::string> times(2, "t");
+	std::vector<double> values(2, 4.0);
+	d.addTimeSeries(times, values);
+	Attribute e(d);
+	std::vector<std::string> t;
+	std::vector<double> val;
+	e.getTimeSeries(&t, &val);
+	ASSERT_TRUE(t.size() == 2 && val[1] == 4.0);
+}
+
+TEST_F(TestSystem, AttributeCodec)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test attribute codec";
+
+	std::vector<double> doubles;
+	for(int i=0;i<100;i++)
+		doubles.push_back(i*0.5);
+	std::vector<double> doublesResult;
+	ASSERT_TRUE(AttributeCodec::Decode(AttributeCodec::Encode(doubles), &doublesResult));
+	ASSERT_TRUE(doublesResult == doubles);
+
+	std::vector<std::string> strings;
+	strings.push_back("");
+	strings.push_back("string");
+	std::vector<std::string> stringsResult;
+	ASSERT_TRUE(AttributeCodec::Decode(AttributeCodec::Encode(strings), &stringsResult));
+	ASSERT_TRUE(stringsResult == strings);
+
+	std::vector<LinkAttribute> links;
+	links.push_back(LinkAttribute("view", "uuid"));
+	std::vector<LinkAttribute> linksResult;
+	ASSERT_TRUE(AttributeCodec::Decode(AttributeCodec::Encode(links), &linksResult));
+	ASSERT_TRUE(linksResult == links);
+
+	// repeating timestamps are compressed
+	TimeSeriesAttribute ts;
+	for(int i=0;i<1000;i++)
+	{
+		ts.timestamp.push_back(QString("2012-01-01 %1:00:00").arg(i%24).toStdString());
+		ts.value.push_back(i);
+	}
+	QByteArray encoded = AttributeCodec::Encode(ts);
+	ASSERT_TRUE(encoded.size() < 1000*(19+4+8)/2);
+	TimeSeriesAttribute tsResult;
+	ASSERT_TRUE(AttributeCodec::Decode(encoded, &tsResult));
+	ASSERT_TRUE(tsResult.timestamp == ts.timestamp && tsResult.value == ts.value);
+
+	// truncated data is rejected
+	ASSERT_FALSE(AttributeCodec::Decode(encoded.left(encoded.size()/2), &tsResult));
+	ASSERT_TRUE(tsResult.value.size() == 0);
+
+	// a corrupt size in the header of a compressed block is rejected without allocating it
+	ASSERT_TRUE(encoded[1] != 0);
+	const unsigned int corruptSizes[3] = {0xFFFFFFFF, 0x7FFFFFFF, (unsigned int)encoded.size()*255 + 1024};
+	for(int i=0;i<3;i++)
+	{
+		QByteArray corrupt = encoded;
+		for(int k=0;k<4;k++)
+			corrupt[2+k] = (char)(corruptSizes[i] >> (8*k));
+		ASSERT_FALSE(AttributeCodec::Decode(corrupt, &tsResult));
+		ASSERT_TRUE(tsResult.value.size() == 0);
+	}
+	QByteArray block;
+	ASSERT_FALSE(AttributeCodec::Decompress(encoded.constData() + 6, encoded.size() - 6, -1, &block));
+}
+
+TEST_F(TestSystem, NumericTimeSeries)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test numeric time series";
+
+	std::vector<double> times, values;
+	for(int i=0;i<8760;i++)
+	{
+		times.push_back(1325376000 + i*3600);
+		values.push_back(i);
+	}
+	Attribute* a = new Attribute("flow");
+	a->setTimeSeries(times, values);
+	ASSERT_TRUE(a->getType() == Attribute::NUMERICTIMESERIES);
+
+	// spans share the series and keep it alive
+	TimeSeriesSpan span = a->getTimeSeriesSpan();
+	ASSERT_TRUE(span.size() == 8760);
+	ASSERT_TRUE(a->getTimeSeriesSpan().valueData() == span.valueData());
+	ASSERT_DOUBLE_EQ(span.time(1), 1325379600);
+	delete a;
+	ASSERT_DOUBLE_EQ(span.value(8759), 8759);
+
+	// conversion from and to string timestamps
+	std::vector<std::string> timestamps;
+	timestamps.push_back("2012-01-01 00:00:00");
+	timestamps.push_back("2012-01-01T01:00:00");
+	timestamps.push_back("1325383200");
+	std::vector<double> tsValues(3, 1.0);
+	Attribute b("rain");
+	b.addTimeSeries(timestamps, tsValues);
+	span = b.getTimeSeriesSpan();
+	ASSERT_TRUE(span.size() == 3);
+	ASSERT_DOUBLE_EQ(span.time(0), 1325376000);
+	ASSERT_DOUBLE_EQ(span.time(1), 1325379600);
+	ASSERT_DOUBLE_EQ(span.time(2), 1325383200);
+	ASSERT_TRUE(b.getType() == Attribute::TIMESERIES);
+	ASSERT_TRUE(b.toNumericTimeSeries());
+	ASSERT_TRUE(b.getType() == Attribute::NUMERICTIMESERIES);
+
+	std::vector<std::string> timestampsOut;
+	std::vector<double> valuesOut;
+	b.getTimeSeries(&timestampsOut, &valuesOut);
+	ASSERT_TRUE(timestampsOut.size() == 3 && valuesOut == tsValues);
+	ASSERT_TRUE(timestampsOut[2] == "2012-01-01 02:00:00");
+
+	timestamps[1] = "no date";
+	Attribute c("c");
+	c.addTimeSeries(timestamps, tsValues);
+	ASSERT_TRUE(c.getTimeSeriesSpan().empty());
+	ASSERT_FALSE(c.toNumericTimeSeries());
+	ASSERT_TRUE(c.getType() == Attribute::TIMESERIES);
+
+	NumericTimeSeries decoded;
+	ASSERT_TRUE(AttributeCodec::Decode(AttributeCodec::Encode(NumericTimeSeries(times, values)), &decoded));
+	ASSERT_TRUE(decoded.times == times && decoded.values == values);
+
+	Attribute d("d");
+	d.setType(Attribute::NUMERICTIMESERIES);
+	ASSERT_TRUE(d.getType() == Attribute::NUMERICTIMESERIES);
+	ASSERT_TRUE(d.getTimeSeriesSpan().empty());
+}
+
+TEST_F(TestSystem, ComponentNames)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test component names across successor states";
+
+	System* sys = new System();
+	Node* n1 = sys->addNode(0,0,0);
+	Node* n2 = sys->addNode(1,0,0);
+	Edge* e = sys->addEdge(n1, n2);
+
+	// names are created on request, without writing the string uuid
+	QUuid name = e->getNameUUID();
+	ASSERT_FALSE(name.isNull());
+	ASSERT_TRUE(name == e->getNameUUID());
+	ASSERT_FALSE(e->getAllAttributes().count(UUID_ATTRIBUTE_NAME));
+	ASSERT_TRUE(sys->getComponentByName(name) == e);
+
+	// the successor copies the edge and its nodes, the names stay the same
+	System* succ = sys->createSuccessor();
+	Edge* succEdge = (Edge*)succ->getComponentByName(name);
+	ASSERT_TRUE(succEdge != NULL && succEdge != e);
+	ASSERT_TRUE(succEdge->getNameUUID() == name);
+	ASSERT_TRUE(succEdge->getQUUID() != e->getQUUID());
+	ASSERT_TRUE(succEdge->getStartNode() != n1);
+	ASSERT_TRUE(succEdge->getStartNode()->getNameUUID() == n1->getNameUUID());
+	ASSERT_TRUE(succ->getComponentByName(n2->getNameUUID()) == succEdge->getEndNode());
+	ASSERT_TRUE(succ->getComponentByName(QUuid::createUuid()) == NULL);
+
+	// the string uuid is the name
+	ASSERT_TRUE(e->getUUID() == name.toString().toStdString());
+	ASSERT_TRUE(succ->getEdge(e->getUUID()) == succEdge);
+	ASSERT_TRUE(succEdge->getUUID() == e->getUUID());
+	delete sys;
+}
+
+TEST_F(TestSystem, SuccessorSharing)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test successor states sharing data with their predecessor";
+
+	System* sys = new System();
+	View view("nodes", NODE, MODIFY);
+	Node* n1 = sys->addNode(1,2,3, view);
+	Node* n2 = sys->addNode(4,5,6, view);
+	n1->addAttribute("a", 1.0);
+
+	// view lists are shared until a state changes them
+	System* succ = sys->createSuccessor();
+	succ->addDataViewer(View("nodes", NODE, READ));
+	std::vector<Component*> succNodes = succ->getDataViewer("nodes")->getComponents();
+	ASSERT_TRUE(succNodes.size() == 2 && succNodes[0] == n1);
+
+	// copies read the coordinates of the predecessor until they are changed
+	succ->addDataViewer(View("nodes", NODE, MODIFY));
+	succNodes = succ->getDataViewer("nodes")->getComponents();
+	ASSERT_TRUE(succNodes.size() == 2);
+	Node* c1 = (Node*)succNodes[0];
+	Node* c2 = (Node*)succNodes[1];
+	ASSERT_TRUE(c1 != n1 && c2 != n2);
+	ASSERT_TRUE(c1->getX() == 1 && c1->getY() == 2 && c1->getZ() == 3);
+	ASSERT_DOUBLE_EQ(c1->getAttribute("a")->getDouble(), 1.0);
+	ASSERT_TRUE(succ->getNodeStore()->Count() == 0);
+	c1->setY(20);
+	c2->set(40, 50, 60);
+	// changed copies move into the store of their state
+	ASSERT_TRUE(succ->getNodeStore()->Count() == 2);
+	ASSERT_TRUE(c1->getX() == 1 && c1->getY() == 20 && c1->getZ() == 3);
+	ASSERT_TRUE(c2->getX() == 40 && c2->getZ() == 60);
+	ASSERT_TRUE(n1->getY() == 2);
+	ASSERT_TRUE(n2->getX() == 4 && n2->getZ() == 6);
+
+	// the predecessor keeps its own components
+	std::vector<Component*> nodes = sys->getDataViewer("nodes")->getComponents();
+	ASSERT_TRUE(nodes.size() == 2 && nodes[0] == n1 && nodes[1] == n2);
+
+	// copies of copies
+	System* succ2 = succ->createSuccessor();
+	Node* c3 = (Node*)succ2->getComponentByName(c2->getNameUUID());
+	ASSERT_TRUE(c3 != c2 && c3->getX() == 40);
+	Node* c4 = (Node*)succ2->getComponentByName(n1->getNameUUID());
+	ASSERT_TRUE(c4 != c1 && c4->getY() == 20);
+	delete sys;
+
+	// slots read by successors are not reused by the predecessor
+	sys = new System();
+	Node* n = sys->addNode(1,2,3);
+	succ = sys->createSuccessor();
+	Node* c = (Node*)succ->getComponentByName(n->getNameUUID());
+	ASSERT_TRUE(sys->removeChild(n));
+	sys->addNode(7,8,9);
+	ASSERT_TRUE(c->getX() == 1 && c->getY() == 2 && c->getZ() == 3);
+	delete sys;
+}
+
+TEST_F(TestSystem, DeferredMigration)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test reading successor states without copying components";
+
+	System* sys = new System();
+	View view("nodes", NODE, MODIFY);
+	Node* n1 = sys->addNode(1,2,3, view);
+	Node* n2 = sys->addNode(4,5,6, view);
+
+	DerivedSystem* succ = (DerivedSystem*)sys->createSuccessor();
+	succ->addDataViewer(view);
+	DataViewer* viewer = succ->getDataViewer("nodes");
+
+	// reading doesn't copy anything
+	std::vector<Component*> nodes = viewer->getComponentsReadOnly();
+	ASSERT_TRUE(nodes.size() == 2 && nodes[0] == n1 && nodes[1] == n2);
+	ASSERT_TRUE(succ->getUUIDs(view).size() == 2);
+	ASSERT_TRUE(succ->getCopyCount() == 0);
+
+	// only the changed component is copied
+	Node* c1 = (Node*)viewer->getWritable(nodes[0]);
+	ASSERT_TRUE(c1 != n1 && c1->getX() == 1);
+	ASSERT_TRUE(viewer->getWritable(nodes[0]) == c1);
+	ASSERT_TRUE(viewer->getWritable(c1) == c1);
+	c1->setX(10);
+	ASSERT_TRUE(succ->getCopyCount() == 1);
+	ASSERT_TRUE(n1->getX() == 1);
+
+	nodes = viewer->getComponentsReadOnly();
+	ASSERT_TRUE(nodes.size() == 2 && nodes[0] == c1 && nodes[1] == n2);
+	ASSERT_TRUE(viewer->getAccessedCount() == 2);
+
+	// a writing view copies the rest, the existing copy is kept
+	nodes = viewer->getComponents();
+	ASSERT_TRUE(nodes.size() == 2 && nodes[0] == c1 && nodes[1] != n2);
+	ASSERT_TRUE(succ->getCopyCount() == 2);
+	ASSERT_TRUE(((Node*)nodes[1])->getX() == 4);
+	delete sys;
+}
+
+TEST_F(TestSystem, NameLookupsInViews)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test views of successor states after copies made by name lookups";
+
+	System* sys = new System();
+	View view("nodes", NODE, MODIFY);
+	sys->addNode(1,2,3, view);
+	sys->addNode(4,5,6, view);
+	sys->addNode(7,8,9, view);
+
+	System* succ = sys->createSuccessor();
+	std::vector<std::string> uuids = succ->getUUIDs(view);
+	ASSERT_TRUE(uuids.size() == 3);
+	Node* changed = succ->getNode(uuids[0]);
+	Node* removed = succ->getNode(uuids[1]);
+	QUuid removedName = removed->getNameUUID();
+	changed->setX(10);
+	ASSERT_TRUE(succ->removeChild(removed));
+	ASSERT_TRUE(succ->getUUIDs(view).size() == 2);
+
+	// the copies replace the originals in the views of this and the next state
+	std::vector<Component*> nodes = succ->getDataViewer("nodes")->getComponentsReadOnly();
+	ASSERT_TRUE(nodes.size() == 2);
+	ASSERT_TRUE(std::find(nodes.begin(), nodes.end(), changed) != nodes.end());
+
+	System* next = succ->createSuccessor();
+	nodes = next->getDataViewer("nodes")->getComponentsReadOnly();
+	ASSERT_TRUE(nodes.size() == 2);
+	ASSERT_TRUE(std::find(nodes.begin(), nodes.end(), changed) != nodes.end());
+	foreach(Component* c, nodes)
+		ASSERT_TRUE(c->getNameUUID() != removedName);
+	ASSERT_TRUE(((Node*)next->getComponentByName(changed->getNameUUID()))->getX() == 10);
+	delete sys;
+}
+
+TEST_F(TestSystem, FlattenSuccessorChain)
+{
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "Test flattening a chain of successor states";
+
+	System* sys = new System();
+	View view("nodes", NODE, MODIFY);
+	Node* n1 = sys->addNode(1,2,3, view);
+	Node* n2 = sys->addNode(4,5,6, view);
+	Edge* e = sys->addEdge(n1, n2, View("edges", EDGE, MODIFY));
+	n1->addAttribute("a", 1.0);
+	QUuid name1 = n1->getNameUUID();
+	QUuid name2 = n2->getNameUUID();
+	QUuid nameE = e->getNameUUID();
+
+	// each state changes one node
+	System* state = sys;
+	for(int i=0;i<10;i++)
+	{
+		state = state->createSuccessor();
+		((Node*)state->getComponentByName(name2))->setX(i);
+	}
+	DerivedSystem* last = (DerivedSystem*)state;
+	ASSERT_TRUE(last->getDepth() == 10);
+	ASSERT_TRUE(last->Flatten());
+	ASSERT_TRUE(last->getDepth() == 0);
+	ASSERT_TRUE(last->getPredecessors().size() == 0);
+	ASSERT_TRUE(sys->getSucessors().size() == 1);
+
+	// the flattened state doesn't need the chain anymore
+	delete sys;
+	Node* c1 = (Node*)last->getComponentByName(name1);
+	Node* c2 = (Node*)last->getComponentByName(name2);
+	Edge* ce = (Edge*)last->getComponentByName(nameE);
+	ASSERT_TRUE(c1 && c2 && ce);
+	ASSERT_TRUE(c1->getX() == 1 && c1->getY() == 2 && c2->getX() == 9);
+	ASSERT_DOUBLE_EQ(c1->getAttribute("a")->getDouble(), 1.0);
+	ASSERT_TRUE(ce->getStartNode() == c1 && ce->getEndNode() == c2);
+	ASSERT_TRUE(c1->getEdges().size() == 1 && c1->getEdges()[0] == ce);
+	ASSERT_TRUE(last->getAllNodes().size() == 2);
+
+	std::vector<Component*> nodes = last->getDataViewer("nodes")->getComponentsReadOnly();
+	ASSERT_TRUE(nodes.size() == 2 && nodes[0] == c1 && nodes[1] == c2);
+
+	// successors may read the predecessors, so their state can't be flattened
+	DerivedSystem* succ = (DerivedSystem*)last->createSuccessor();
+	succ->createSuccessor();
+	ASSERT_TRUE(succ->getDepth() == 1);
+	ASSERT_FALSE(succ->Flatten());
+	delete last;
+}
+
 TEST_F(TestSystem,AttributesInSystem) {
 	ostream *out = &cout;
 	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
@@ -858,6 +1612,62 @@ TEST_F(TestSystem, ViewFilterCheck) {
 	ASSERT_EQ(1, componentsInView.size());
 }
 
+TEST_F(TestSystem, ViewFilterAlternatives) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Error);
+	DM::Logger(DM::Standard) << "check view filters combined with and/or";
+
+	// x < 2 or (x > 3 and value == 1)
+	View view("testview", NODE, READ);
+	view.addAttribute("value");
+	view.addFilter(DataFilter(DataFilter::X, DataFilter::LESS, 2.0));
+	view.addFilter(DataFilter(DataFilter::X, DataFilter::GREATER, 3.0, DataFilter::OR));
+	view.addFilter(DataFilter("value", DataFilter::EQUAL, 1.0));
+
+	System sys;
+	std::vector<Node*> nodes;
+	for(int i=0;i<6;i++)
+	{
+		Node* n = new Node(i, 0, 0);
+		n->addAttribute("value", i%2);
+		nodes.push_back(sys.addNode(n, view));
+	}
+	std::vector<Component*> filtered = sys.getDataViewer("testview")->getComponentsReadOnly();
+	ASSERT_EQ(3, filtered.size());
+	ASSERT_TRUE(filtered[0] == nodes[0] && filtered[1] == nodes[1] && filtered[2] == nodes[5]);
+
+	// alternatives of coordinates only
+	View view2("testview", NODE, READ);
+	view2.addFilter(DataFilter(DataFilter::X, DataFilter::LESS, 1.0));
+	view2.addFilter(DataFilter(DataFilter::X, DataFilter::GREATER, 4.0, DataFilter::OR));
+	sys.addDataViewer(view2);
+	filtered = sys.getDataViewer("testview")->getComponentsReadOnly();
+	ASSERT_EQ(2, filtered.size());
+	ASSERT_TRUE(filtered[0] == nodes[0] && filtered[1] == nodes[5]);
+
+	// adding an and filter to an alternative
+	view2.addAttribute("missing");
+	view2.addFilter(DataFilter("missing", DataFilter::GREATER, 0.0));
+	sys.addDataViewer(view2);
+	filtered = sys.getDataViewer("testview")->getComponentsReadOnly();
+	ASSERT_EQ(1, filtered.size());
+	ASSERT_TRUE(filtered[0] == nodes[0]);
+
+	// filtering doesn't create missing attributes
+	ASSERT_EQ(1, nodes[5]->getAllAttributes().size());
+
+	// added components with filtered attributes moved to the db are filtered by their values
+	View view3("movedview", NODE, READ);
+	view3.addFilter(DataFilter("value", DataFilter::EQUAL, 1.0));
+	Node* moved = new Node(7, 0, 0);
+	moved->addAttribute("value", 1);
+	moved->MoveAttributeToDb("value");
+	moved = sys.addNode(moved, view3);
+	filtered = sys.getDataViewer("movedview")->getComponentsReadOnly();
+	ASSERT_EQ(1, filtered.size());
+	ASSERT_TRUE(filtered[0] == moved);
+}
+
 }
 
 #endif
@@ -1036,6 +1846,112 @@ TEST_F(TestSystem,sqlRasterDataProfiling) {
 }
 */
 
+TEST_F(TestSystem,sqlSelectLatency) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Standard);
+	DM::Logger(DM::Standard) << "Test select latency per cache miss (SQL)";
+
+	const int n = 1000;
+	QElapsedTimer timer;
+
+	// attribute misses: Attribute::LoadAttribute via Component::getAttribute
+	DM::Component* c = new DM::Component;
+	for(int i=0;i<n;i++)
+	{
+		std::stringstream name;
+		name << "name " << i;
+		c->addAttribute(name.str(), i);
+		c->MoveAttributeToDb(name.str());
+	}
+	timer.start();
+	for(int i=0;i<n;i++)
+	{
+		std::stringstream name;
+		name << "name " << i;
+		ASSERT_TRUE(c->getAttribute(name.str())->getDouble() == i);
+	}
+	DM::Logger(DM::Standard) << "attribute load " << (double)timer.nsecsElapsed()/n/1000 << " us/miss";
+	delete c;
+
+	// attribute misses over many components: bulk select via Component::LoadAttributes
+	std::vector<DM::Component*> components;
+	for(int i=0;i<n;i++)
+	{
+		DM::Component* c = new DM::Component;
+		c->addAttribute("bulk", i);
+		c->MoveAttributeToDb("bulk");
+		components.push_back(c);
+	}
+	timer.restart();
+	DM::Component::LoadAttributes(components, "bulk");
+	for(int i=0;i<n;i++)
+		ASSERT_TRUE(components[i]->getAttribute("bulk")->getDouble() == i);
+	DM::Logger(DM::Standard) << "bulk attribute load " << (double)timer.nsecsElapsed()/n/1000 << " us/miss";
+	foreach(DM::Component* c, components)
+		delete c;
+
+	// raster block misses: same query as RasterData::RasterBlockLabel::LoadFromDb
+	QUuid owner = QUuid::createUuid();
+	double buffer[RASTERBLOCKSIZE*RASTERBLOCKSIZE];
+	for(int i=0;i<RASTERBLOCKSIZE*RASTERBLOCKSIZE;i++)
+		buffer[i] = i;
+	QByteArray block((char*)buffer, sizeof(buffer));
+	for(int i=0;i<n;i++)
+	{
+		QSqlQuery *q = DM::DBConnector::getInstance()->getQuery("INSERT INTO rasterfields(owner,x,y,data) VALUES (?,?,?,?)");
+		q->addBindValue(owner.toByteArray());
+		q->addBindValue(QVariant::fromValue(i));
+		q->addBindValue(QVariant::fromValue(0));
+		q->addBindValue(block);
+		DM::DBConnector::getInstance()->ExecuteQuery(q);
+	}
+	timer.restart();
+	for(int i=0;i<n;i++)
+	{
+		QSqlQuery *q = DM::DBConnector::getInstance()->getQuery("SELECT data FROM rasterfields WHERE owner LIKE ? AND x=? AND y=?");
+		q->addBindValue(owner.toByteArray());
+		q->addBindValue(QVariant::fromValue(i));
+		q->addBindValue(QVariant::fromValue(0));
+		QList<QList<QVariant> > rows;
+		ASSERT_TRUE(DM::DBConnector::getInstance()->ExecuteSelectQuery(q, &rows));
+		ASSERT_TRUE(rows.at(0).at(0).toByteArray().size() == block.size());
+	}
+	DM::Logger(DM::Standard) << "raster block load " << (double)timer.nsecsElapsed()/n/1000 << " us/miss";
+
+	QSqlQuery *q = DM::DBConnector::getInstance()->getQuery("DELETE FROM rasterfields WHERE owner LIKE ?");
+	q->addBindValue(owner.toByteArray());
+	DM::DBConnector::getInstance()->ExecuteQuery(q);
+}
+
+void writeAttributes(int n)
+{
+	for(int i=0;i<n;i++)
+	{
+		DM::Component c;
+		c.addAttribute("concurrent", i);
+		c.MoveAttributeToDb("concurrent");
+	}
+}
+
+TEST_F(TestSystem,sqlConcurrentWrites) {
+	ostream *out = &cout;
+	DM::Log::init(new DM::OStreamLogSink(*out), DM::Standard);
+	DM::Logger(DM::Standard) << "Test concurrent writes (SQL)";
+
+	const int n = 100000;
+	QElapsedTimer timer;
+	for(int threads=1;threads<=8;threads*=2)
+	{
+		timer.restart();
+		QFutureSynchronizer<void> sync;
+		for(int t=0;t<threads;t++)
+			sync.addFuture(QtConcurrent::run(writeAttributes, n/threads));
+		sync.waitForFinished();
+		DM::DBConnector::getInstance()->Synchronize();
+		DM::Logger(DM::Standard) << threads << " threads: " << (long)timer.elapsed() << " ms for " << n << " attribute writes";
+	}
+}
+
 #endif // SQLPROFILING
 
 bool init_table()